@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Bench {
+
+    // Positions searched by the benchmark, in order
+    static const std::vector<std::string> POSITIONS;
+
+    /**
+     * Searches every benchmark position to a fixed depth, starting from an empty transposition
+     * table each time, and prints the total node count, elapsed time and nodes/second. With a
+     * single thread the node count is a signature of the search tree: it must not change unless
+     * the search or evaluation functionally changes.
+     * @param depth the depth of every search.
+     * @param nThreads the number of search threads.
+     * @param hashMB the size of the transposition table in megabytes.
+     * @return the total number of nodes searched.
+     */
+    static uint64_t run(int depth, size_t nThreads, size_t hashMB);
+
+    /**
+     * Parses "bench [depth] [threads] [hashMB]" arguments and runs the benchmark.
+     * @param args the arguments following the command name.
+     */
+    static void parseBenchString(const std::vector<std::string> &args);
+
+    /**
+     * Runs a single threaded perft of the start position and the benchmark once with magic and once
+     * with PEXT sliding attack lookups, checks both count the same nodes, and prints their speeds side
+     * by side. The backend detected at startup is selected again afterwards.
+     * @param depth the depth of every benchmark search.
+     */
+    static void compareSliderBackends(int depth);
+};
@@ -21,6 +21,8 @@ const uint64_t Bitboard::BB_SQUARES[64] =
 
 const uint64_t Bitboard::BB_ALL = 0xffffffffffffffff;
 
+const uint64_t Bitboard::BB_LIGHT_SQUARES = 0x55aa55aa55aa55aa;
+
 const uint64_t Bitboard::BB_FILE_A = 0x0101010101010101;
 const uint64_t Bitboard::BB_FILE_B = Bitboard::BB_FILE_A << 1;
 const uint64_t Bitboard::BB_FILE_C = Bitboard::BB_FILE_A << 2;
@@ -133,13 +135,42 @@ const uint64_t Bitboard::BB_ANTI_DIAGONALS[15] =
     Bitboard::BB_ANTI_DIAGONAL_15
 };
 
-uint64_t Bitboard::BB_RAYS[64][64];
-
-const int Bitboard::MAX_MOVE_NUM = 218;
+const int Bitboard::MAX_MOVE_NUM;
 const int Bitboard::MAX_CAPTURE_NUM = 74;
 const int Bitboard::MAX_ATTACK_NUM = 16;
 
-uint64_t Bitboard::ZOBRIST_VALUES[781];
+static constexpr zobrist_table_t generateZobrist() {
+    zobrist_table_t table = {};
+    uint64_t state = 0x4a554c4945545445ULL;
+    for (int i = 0; i < 781; ++i) table.keys[i] = BitUtils::splitmix64(state);
+    return table;
+}
+
+constexpr zobrist_table_t Bitboard::ZOBRIST_VALUES = generateZobrist();
+
+/**
+ * The PSQTs are laid out from white's side of the board, so a black piece reads the vertically mirrored
+ * square and counts against white.
+ */
+static constexpr psqt_table_t generatePSQT() {
+    psqt_table_t table = {};
+    const uint16_t phase[6] = {Weights::PAWN_PHASE, Weights::KNIGHT_PHASE, Weights::BISHOP_PHASE,
+                               Weights::ROOK_PHASE, Weights::QUEEN_PHASE, 0};
+    for (int type = piece_t::BLACK_PAWN; type <= piece_t::BLACK_KING; ++type) {
+        const int32_t mgMaterial = Weights::MATERIAL[type];
+        const int32_t egMaterial = type == piece_t::BLACK_KING ? 0 : Weights::Endgame::MATERIAL[type];
+        for (int square = 0; square < 64; ++square) {
+            table.midgame[type + 6][square] = mgMaterial + Weights::PSQTs[type][square];
+            table.endgame[type + 6][square] = egMaterial + Weights::Endgame::PSQTs[type][square];
+            table.midgame[type][square] = -(mgMaterial + Weights::PSQTs[type][square ^ 56]);
+            table.endgame[type][square] = -(egMaterial + Weights::Endgame::PSQTs[type][square ^ 56]);
+        }
+        table.phase[type] = table.phase[type + 6] = phase[type];
+    }
+    return table;
+}
+
+constexpr psqt_table_t Bitboard::PSQT_VALUES = generatePSQT();
 
 int Bitboard::fileOf(int square) {
     return square % 8;
@@ -165,10 +196,6 @@ uint64_t Bitboard::getRayBetweenInclusive(int square1, int square2) {
     return Bitboard::BB_RAYS[square1][square2];
 }
 
-void Bitboard::initializeZobrist() {
-    for (int i = 0; i < 781; ++i) Bitboard::ZOBRIST_VALUES[i] = BitUtils::getRandomBitstring();
-}
-
 Bitboard::Bitboard(const std::string &fen) {
     char *rest = strdup(fen.c_str());
     char *og_rest = rest;
@@ -177,18 +204,14 @@ Bitboard::Bitboard(const std::string &fen) {
     for (int i = Squares::A1; i <= Squares::H8; ++i) {
         this->mailbox[i] = piece_t::EMPTY;
     }
-    this->wPawns = 0;
-    this->wKnights = 0;
-    this->wBishops = 0;
-    this->wRooks = 0;
-    this->wQueens = 0;
-    this->wKing = 0;
-    this->bPawns = 0;
-    this->bKnights = 0;
-    this->bBishops = 0;
-    this->bRooks = 0;
-    this->bQueens = 0;
-    this->bKing = 0;
+    std::memset(this->typeBB, 0, sizeof(this->typeBB));
+    std::memset(this->colorBB, 0, sizeof(this->colorBB));
+    this->occupied = 0;
+    this->midgameScore = 0;
+    this->endgameScore = 0;
+    this->phase = 0;
+    this->pawn_hash_code = 0;
+    this->material_key = 0;
     for (int rank = 7; rank >= 0; --rank) {
         char *fen_board = strtok_r(token, "/", &token);
         int file = 0;
@@ -200,23 +223,15 @@ Bitboard::Bitboard(const std::string &fen) {
             if (isdigit(piece)) {
                 file += piece - '0';
             } else {
-                int square = 8 * rank + file;
-                this->mailbox[square] = ConversionUtils::toEnum(piece);
-                uint64_t *bitboard = this->getBitboard(ConversionUtils::toEnum(piece));
-                BitUtils::setBit(bitboard, square);
+                this->_put_piece(ConversionUtils::toEnum(piece), 8 * rank + file);
                 ++file;
             }
         }
     }
-    this->wOccupied =
-            this->wPawns | this->wKnights | this->wBishops | this->wRooks | this->wQueens | this->wKing;
-    this->bOccupied =
-            this->bPawns | this->bKnights | this->bBishops | this->bRooks | this->bQueens | this->bKing;
-    this->occupied = this->wOccupied | this->bOccupied;
 
     // Initalize king squares
-    this->wKingSquare = BitUtils::getLSB(this->wKing);
-    this->bKingSquare = BitUtils::getLSB(this->bKing);
+    this->wKingSquare = BitUtils::getLSB(this->pieces(WHITE, KING));
+    this->bKingSquare = BitUtils::getLSB(this->pieces(BLACK, KING));
 
     // Initalize turn
     token = strtok_r(rest, " ", &rest);
@@ -283,36 +298,112 @@ Bitboard::Bitboard(const std::string &fen) {
     if (this->en_passant_square != INVALID) {
         this->hash_code ^= Bitboard::ZOBRIST_VALUES[773 + Bitboard::fileOf(this->en_passant_square)];
     }
+    this->stateValid = false;
     free(og_rest);
 }
 
-Bitboard::Bitboard() {}
+Bitboard::Bitboard() {
+    this->stateValid = false;
+}
 
-int Bitboard::genLegalMoves(move_t *moves, bool color) {
+/**
+ * @tparam Color the color of the pawns.
+ * @param pawns the pawns.
+ * @return the squares attacked by the pawns.
+ */
+template<bool Color>
+static inline uint64_t pawnAttacks(uint64_t pawns) {
+    return Color == WHITE ? ((pawns << 9) & ~Bitboard::BB_FILE_A) | ((pawns << 7) & ~Bitboard::BB_FILE_H)
+                          : ((pawns >> 9) & ~Bitboard::BB_FILE_H) | ((pawns >> 7) & ~Bitboard::BB_FILE_A);
+}
+
+/**
+ * @tparam Shift how far the pieces move, towards the eighth rank if positive.
+ * @param bb the pieces.
+ * @return the pieces moved by the shift, without wrapping between the a and h files.
+ */
+template<int Shift>
+static inline uint64_t shifted(uint64_t bb) {
+    switch (Shift) {
+        case 7:
+        case -9:
+            return (Shift > 0 ? bb << Shift : bb >> -Shift) & ~Bitboard::BB_FILE_H;
+        case 9:
+        case -7:
+            return (Shift > 0 ? bb << Shift : bb >> -Shift) & ~Bitboard::BB_FILE_A;
+        default:
+            return Shift > 0 ? bb << Shift : bb >> -Shift;
+    }
+}
+
+/**
+ * Adds a move to each target square, made by the piece a fixed offset behind it.
+ * @param offset the distance from the origin of each move to its target.
+ * @return the number of moves added.
+ */
+static inline int serializeTargets(move_t *moves, uint64_t targets, int offset, MoveFlags flag) {
     int i = 0;
-    uint64_t pieces;
-    uint64_t king_bb;
-    int king_square;
-    uint64_t enemy_pawns_attacks;
-    if (color == WHITE) {
-        pieces = this->wOccupied;
-        king_bb = this->wKing;
-        king_square = this->wKingSquare;
-        enemy_pawns_attacks = (((this->bPawns >> 9) & ~Bitboard::BB_FILE_H) | ((this->bPawns >> 7) & ~Bitboard::BB_FILE_A)) & this->wOccupied;
-    } else {
-        pieces = this->bOccupied;
-        king_bb = this->bKing;
-        king_square = this->bKingSquare;
-        enemy_pawns_attacks = (((this->wPawns << 9) & ~Bitboard::BB_FILE_A) | ((this->wPawns << 7) & ~Bitboard::BB_FILE_H)) & this->bOccupied;
+    while (targets) {
+        int to = BitUtils::pullLSB(&targets);
+        moves[i++] = {(unsigned int) (to - offset), (unsigned int) to, (unsigned int) flag};
     }
+    return i;
+}
 
-    uint64_t attackmask = this->_get_attackmask(!color);
-    uint64_t checkmask = this->_get_checkmask(color);
-    uint64_t pos_pinned = this->get_queen_moves(!color, king_square) & pieces;
+/**
+ * Adds all four promotions to each target square, made by the pawn a fixed offset behind it.
+ * @param offset the distance from the origin of each move to its target.
+ * @param capture whether the promotions are captures.
+ * @return the number of moves added.
+ */
+static inline int serializePromotions(move_t *moves, uint64_t targets, int offset, bool capture) {
+    const unsigned int queen = capture ? MoveFlags::PC_QUEEN : MoveFlags::PR_QUEEN;
+    int i = 0;
+    while (targets) {
+        const unsigned int to = BitUtils::pullLSB(&targets), from = to - offset;
+        moves[i++] = {from, to, queen};
+        moves[i++] = {from, to, queen - 1};
+        moves[i++] = {from, to, queen - 2};
+        moves[i++] = {from, to, queen - 3};
+    }
+    return i;
+}
+
+int Bitboard::genLegalMoves(move_t *moves, bool color) {
+    return color == WHITE ? this->_gen_moves<WHITE, true>(moves) : this->_gen_moves<BLACK, true>(moves);
+}
+
+int Bitboard::genLegalCaptures(move_t *moves, bool color) {
+    return color == WHITE ? this->_gen_captures<WHITE, true>(moves) : this->_gen_captures<BLACK, true>(moves);
+}
+
+int Bitboard::genNonquiescentMoves(move_t *moves, bool color) {
+    return color == WHITE ? this->_gen_nonquiescent_moves<WHITE, true>(moves) : this->_gen_nonquiescent_moves<BLACK, true>(moves);
+}
+
+int Bitboard::genPseudoLegalMoves(move_t *moves) {
+    return this->turn == WHITE ? this->_gen_moves<WHITE, false>(moves) : this->_gen_moves<BLACK, false>(moves);
+}
+
+int Bitboard::genPseudoLegalNonquiescentMoves(move_t *moves) {
+    return this->turn == WHITE ? this->_gen_nonquiescent_moves<WHITE, false>(moves)
+                               : this->_gen_nonquiescent_moves<BLACK, false>(moves);
+}
+
+template<bool Color, bool Legal>
+int Bitboard::_gen_moves(move_t *moves) {
+    int i = 0;
+
+    uint64_t pieces = this->colorBB[Color] & ~this->typeBB[PAWN];
+    const int king_square = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+
+    const stateinfo_t state = this->_get_state_of<Color>();
+    const uint64_t attackmask = state.attackmask;
+    const uint64_t checkmask = state.checkmask;
 
     // King is in double check, only moves are to move king away
     if (!checkmask) {
-        uint64_t moves_bb = this->get_king_moves(color, king_square) & ~attackmask;
+        uint64_t moves_bb = this->get_king_moves<Color>(king_square) & ~attackmask;
         while (moves_bb) {
             int to = BitUtils::pullLSB(&moves_bb);
             MoveFlags flag = this->getFlag(piece_t::BLACK_KING, king_square, to);
@@ -323,46 +414,31 @@ int Bitboard::genLegalMoves(move_t *moves, bool color) {
         return i;
     }
 
+    i += this->_gen_pawn_moves<Color, true, Legal>(moves, state);
+
     while (pieces) {
         const int from = BitUtils::pullLSB(&pieces);
         piece_t piece = static_cast<piece_t>(this->mailbox[from] % 6);
 
-        uint64_t pinned_bb = Bitboard::BB_SQUARES[from] & pos_pinned;
-        uint64_t pinmask = pinned_bb ? this->_get_pinmask(color, from) : Bitboard::BB_ALL;
+        uint64_t pinned_bb = Legal ? Bitboard::BB_SQUARES[from] & state.pinned : 0;
+        uint64_t pinmask = pinned_bb ? Bitboard::BB_RAYS[king_square][from] : Bitboard::BB_ALL;
 
         uint64_t moves_bb;
         switch (piece) {
-            case piece_t::BLACK_PAWN: {
-                uint64_t pawn_moves = this->get_pawn_moves(color, from);
-                moves_bb = pawn_moves & checkmask & pinmask;
-
-                if (this->en_passant_square != INVALID) {
-                    if (pawn_moves & pinmask & Bitboard::BB_SQUARES[this->en_passant_square]) {
-                        // Add possible en passant capture to remove check
-                        // For example en passant is legal here:
-                        // 8/8/8/2k5/3Pp3/8/8/3K4 b - d3 0 1
-                        if (king_bb & enemy_pawns_attacks) {
-                            BitUtils::setBit(&moves_bb, this->en_passant_square);
-                        }
-                    }
-                }
-
-                break;
-            }
             case piece_t::BLACK_KNIGHT:
-                moves_bb = this->get_knight_moves(color, from) & checkmask & pinmask;
+                moves_bb = this->get_knight_moves<Color>(from) & checkmask & pinmask;
                 break;
             case piece_t::BLACK_BISHOP:
-                moves_bb = this->get_bishop_moves(color, from) & checkmask & pinmask;
+                moves_bb = this->get_bishop_moves<Color>(from) & checkmask & pinmask;
                 break;
             case piece_t::BLACK_ROOK:
-                moves_bb = this->get_rook_moves(color, from) & checkmask & pinmask;
+                moves_bb = this->get_rook_moves<Color>(from) & checkmask & pinmask;
                 break;
             case piece_t::BLACK_QUEEN:
-                moves_bb = this->get_queen_moves(color, from) & checkmask & pinmask;
+                moves_bb = this->get_queen_moves<Color>(from) & checkmask & pinmask;
                 break;
             case piece_t::BLACK_KING:
-                moves_bb = this->get_king_moves(color, from) & ~attackmask;
+                moves_bb = this->get_king_moves<Color>(from) & ~attackmask;
                 break;
             default:
                 exit(-1);
@@ -370,116 +446,30 @@ int Bitboard::genLegalMoves(move_t *moves, bool color) {
 
         while (moves_bb) {
             int to = BitUtils::pullLSB(&moves_bb);
-            if (piece == piece_t::BLACK_PAWN && (Bitboard::rankOf(to) == 0 || Bitboard::rankOf(to) == 7)) { // Add all promotions
-                if (this->mailbox[to] == piece_t::EMPTY) {
-                    move_t queen_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PR_QUEEN};
-                    moves[i++] = queen_promotion;
-                    move_t rook_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PR_ROOK};
-                    moves[i++] = rook_promotion;
-                    move_t bishop_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PR_BISHOP};
-                    moves[i++] = bishop_promotion;
-                    move_t knight_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PR_KNIGHT};
-                    moves[i++] = knight_promotion;
-                } else {
-                    move_t queen_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_QUEEN};
-                    moves[i++] = queen_promotion;
-                    move_t rook_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_ROOK};
-                    moves[i++] = rook_promotion;
-                    move_t bishop_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_BISHOP};
-                    moves[i++] = bishop_promotion;
-                    move_t knight_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_KNIGHT};
-                    moves[i++] = knight_promotion;
-                }
-
-            } else {
-                int flag = this->getFlag(piece, from, to);
-                move_t move = {(unsigned int) from, (unsigned int) to, (unsigned int) flag};
-
-                // Determine if castling is legal
-                if (flag == MoveFlags::CASTLING) {
-                    if (attackmask & king_bb) continue; // Assert the king is not in check
-                    if (color == WHITE) {
-                        if (from != Squares::E1) continue; // Assert the king is still alive
-                        if (to == Squares::G1) { // Kingside
-                            if (!this->wKingsideCastleRights) continue; // Assert king or rook has not moved
-                            if (!(this->wRooks & Bitboard::BB_SQUARES[Squares::H1])) continue; // Assert rook is still alive
-                            if (this->occupied & (Bitboard::BB_SQUARES[Squares::F1] | Bitboard::BB_SQUARES[Squares::G1]))
-                                continue; // Assert there are no pieces between the king and rook
-                            if (attackmask & (Bitboard::BB_SQUARES[F1] | Bitboard::BB_SQUARES[Squares::G1]))
-                                continue; // Assert the squares the king moves through are not attacked
-                        } else if (to == Squares::C1) { // Queenside
-                            if (!this->wQueensideCastleRights) continue;
-                            if (!(this->wRooks & Bitboard::BB_SQUARES[Squares::A1])) continue;
-                            if (this->occupied & (Bitboard::BB_SQUARES[Squares::D1] | Bitboard::BB_SQUARES[Squares::C1] | Bitboard::BB_SQUARES[Squares::B1])) continue;
-                            if (attackmask & (Bitboard::BB_SQUARES[Squares::D1] | Bitboard::BB_SQUARES[Squares::C1])) continue;
-                        } else {
-                            continue;
-                        }
-                    } else {
-                        if (from != Squares::E8) continue;
-                        if (to == Squares::G8) { // Kingside
-                            if (!this->bKingsideCastleRights) continue;
-                            if (!(this->bRooks & Bitboard::BB_SQUARES[Squares::H8])) continue;
-                            if (this->occupied & (Bitboard::BB_SQUARES[Squares::F8] | Bitboard::BB_SQUARES[Squares::G8])) continue;
-                            if (attackmask & (Bitboard::BB_SQUARES[Squares::F8] | Bitboard::BB_SQUARES[Squares::G8])) continue;
-                        } else if (to == Squares::C8) { // Queenside
-                            if (!this->bQueensideCastleRights) continue;
-                            if (!(this->bRooks & Bitboard::BB_SQUARES[Squares::A8])) continue;
-                            if (this->occupied & (Bitboard::BB_SQUARES[Squares::D8] | Bitboard::BB_SQUARES[Squares::C8] | Bitboard::BB_SQUARES[Squares::B8])) continue;
-                            if (attackmask & (Bitboard::BB_SQUARES[Squares::D8] | Bitboard::BB_SQUARES[Squares::C8])) continue;
-                        } else {
-                            continue;
-                        }
-                    }
-                } else if (flag == MoveFlags::EN_PASSANT) {
-                    // Remove possible en passant capture that leaves king in check
-                    // For example en passant is illegal here:
-                    // 8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1
-                    // k7/1q6/8/3pP3/8/5K2/8/8 w - d6 0 1
-                    const Bitboard copy = *this;
-                    this->makeMove(move);
-                    bool invalid = this->isInCheck(color);
-                    *this = copy;
-                    if (invalid) continue;
-                }
-                moves[i++] = move;
-            }
+            int flag = this->getFlag(piece, from, to);
+            if (flag == MoveFlags::CASTLING && !this->canCastle<Color>(from, to, attackmask)) continue;
+            move_t move = {(unsigned int) from, (unsigned int) to, (unsigned int) flag};
+            moves[i++] = move;
         }
     }
     return i;
 }
 
-int Bitboard::genLegalCaptures(move_t *moves, bool color) {
+template<bool Color, bool Legal>
+int Bitboard::_gen_captures(move_t *moves) {
     int i = 0;
 
-    uint64_t pieces;
-    uint64_t kingBb;
-    int kingSquare;
-    uint64_t enemyPawnAttacks;
-    uint64_t enemyBb;
-    if (color == WHITE) {
-        pieces = this->wOccupied;
-        kingBb = this->wKing;
-        kingSquare = this->wKingSquare;
-        enemyPawnAttacks = (((this->bPawns >> 9) & ~Bitboard::BB_FILE_H) | ((this->bPawns >> 7) & ~Bitboard::BB_FILE_A))
-                              & this->wOccupied;
-        enemyBb = this->bOccupied;
-    } else {
-        pieces = this->bOccupied;
-        kingBb = this->bKing;
-        kingSquare = this->bKingSquare;
-        enemyPawnAttacks = (((this->wPawns << 9) & ~Bitboard::BB_FILE_A) | ((this->wPawns << 7) & ~Bitboard::BB_FILE_H))
-                              & this->bOccupied;
-        enemyBb = this->wOccupied;
-    }
+    uint64_t pieces = this->colorBB[Color] & ~this->typeBB[PAWN];
+    const int kingSquare = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+    const uint64_t enemyBb = this->colorBB[!Color];
 
-    uint64_t attackmask = this->_get_attackmask(!color);
-    uint64_t checkmask = this->_get_checkmask(color);
-    uint64_t posPinned = this->get_queen_moves(!color, kingSquare) & pieces;
+    const stateinfo_t state = this->_get_state_of<Color>();
+    const uint64_t attackmask = state.attackmask;
+    const uint64_t checkmask = state.checkmask;
 
     // King is in double check, only moves are to king moves away that are captures
     if (!checkmask) {
-        uint64_t moves_bb = this->get_king_moves(color, kingSquare) & ~attackmask & enemyBb;
+        uint64_t moves_bb = this->get_king_moves<Color>(kingSquare) & ~attackmask & enemyBb;
         while (moves_bb) {
             int to = BitUtils::pullLSB(&moves_bb);
             int flag = this->getFlag(piece_t::BLACK_KING, kingSquare, to);
@@ -489,44 +479,30 @@ int Bitboard::genLegalCaptures(move_t *moves, bool color) {
         return i;
     }
 
+    i += this->_gen_pawn_moves<Color, false, Legal>(moves, state);
+
     while (pieces) {
         const int from = BitUtils::pullLSB(&pieces);
         piece_t piece = static_cast<piece_t> (this->mailbox[from] % 6);
-        uint64_t pinnedBb = Bitboard::BB_SQUARES[from] & posPinned;
-        uint64_t pinmask = pinnedBb ? this->_get_pinmask(color, from) : Bitboard::BB_ALL;
+        uint64_t pinnedBb = Legal ? Bitboard::BB_SQUARES[from] & state.pinned : 0;
+        uint64_t pinmask = pinnedBb ? Bitboard::BB_RAYS[kingSquare][from] : Bitboard::BB_ALL;
 
         uint64_t movesBb;
         switch (piece) {
-            case piece_t::BLACK_PAWN: {
-                uint64_t pawnMoves = this->get_pawn_moves(color, from);
-                movesBb = pawnMoves & checkmask & pinmask & enemyBb;
-
-                if (this->en_passant_square != INVALID) {
-                    if (pawnMoves & pinmask & Bitboard::BB_SQUARES[this->en_passant_square]) {
-                        // Add possible en passant capture to remove check
-                        // For example en passant is legal here:
-                        // 8/8/8/2k5/3Pp3/8/8/3K4 b - d3 0 1
-                        if (kingBb & enemyPawnAttacks) {
-                            BitUtils::setBit(&movesBb, this->en_passant_square);
-                        }
-                    }
-                }
-                break;
-            }
             case piece_t::BLACK_KNIGHT:
-                movesBb = this->get_knight_moves(color, from) & checkmask & pinmask & enemyBb;
+                movesBb = this->get_knight_moves<Color>(from) & checkmask & pinmask & enemyBb;
                 break;
             case piece_t::BLACK_BISHOP:
-                movesBb = this->get_bishop_moves(color, from) & checkmask & pinmask & enemyBb;
+                movesBb = this->get_bishop_moves<Color>(from) & checkmask & pinmask & enemyBb;
                 break;
             case piece_t::BLACK_ROOK:
-                movesBb = this->get_rook_moves(color, from) & checkmask & pinmask & enemyBb;
+                movesBb = this->get_rook_moves<Color>(from) & checkmask & pinmask & enemyBb;
                 break;
             case piece_t::BLACK_QUEEN:
-                movesBb = this->get_queen_moves(color, from) & checkmask & pinmask & enemyBb;
+                movesBb = this->get_queen_moves<Color>(from) & checkmask & pinmask & enemyBb;
                 break;
             case piece_t::BLACK_KING:
-                movesBb = get_king_moves_no_castle(color, from) & ~attackmask & enemyBb;
+                movesBb = this->get_king_moves_no_castle<Color>(from) & ~attackmask & enemyBb;
                 break;
             default:
                 std::cout << "Error on movegen.cpp line 509 in gen_legal_captures(move_t *, bool)\n";
@@ -535,98 +511,114 @@ int Bitboard::genLegalCaptures(move_t *moves, bool color) {
 
         while (movesBb) {
             int to = BitUtils::pullLSB(&movesBb);
-            if (piece == piece_t::BLACK_PAWN && (Bitboard::rankOf(to) == 0 || Bitboard::rankOf(to) == 7)) { // Add all promotion captures
-                if (this->mailbox[to] != piece_t::EMPTY) {
-                    move_t queen_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_QUEEN};
-                    moves[i++] = queen_promotion;
-                    move_t rook_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_ROOK};
-                    moves[i++] = rook_promotion;
-                    move_t bishop_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_BISHOP};
-                    moves[i++] = bishop_promotion;
-                    move_t knight_promotion = {(unsigned int) from, (unsigned int) to, MoveFlags::PC_KNIGHT};
-                    moves[i++] = knight_promotion;
-                }
-            } else {
-                MoveFlags flag = this->getFlag(piece, from, to);
-                move_t move = {(unsigned int) from, (unsigned int) to, (unsigned int) flag};
-
-                if (flag == MoveFlags::EN_PASSANT) {
-                    // Remove possible en passant capture that leaves king in check
-                    // For example en passant is illegal here:
-                    // 8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1
-                    // k7/1q6/8/3pP3/8/5K2/8/8 w - d6 0 1
-                    const Bitboard copy = *this;
-                    this->makeMove(move);
-                    bool invalid = this->isInCheck(color);
-                    *this = copy;
-                    if (invalid) continue;
-                }
-                moves[i++] = move;
-            }
+            move_t move = {(unsigned int) from, (unsigned int) to, MoveFlags::CAPTURE};
+            moves[i++] = move;
         }
     }
     return i;
 }
 
-int Bitboard::genNonquiescentMoves(move_t *moves, bool color) {
-    int num_proms = 0;
+template<bool Color, bool Quiets, bool Legal>
+int Bitboard::_gen_pawn_moves(move_t *moves, const stateinfo_t &state) {
+    int i = 0;
 
-    uint64_t pawns, pieces;
-    int king_square;
-    if (color) {
-        pieces = this->wOccupied;
-        king_square = this->wKingSquare;
+    const int up = Color == WHITE ? 8 : -8;
+    const int upDiagonal = Color == WHITE ? 9 : -9;
+    const int upAntiDiagonal = Color == WHITE ? 7 : -7;
+
+    const uint64_t pawns = this->pieces(Color, PAWN);
+    const uint64_t enemyBb = this->colorBB[!Color];
+    const uint64_t lastRank = Color == WHITE ? Bitboard::BB_RANK_8 : Bitboard::BB_RANK_1;
+    const int kingSquare = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+
+    /**
+     * A pinned pawn may only move along the line through its king, so it may push if pinned on the
+     * king's file and capture along the diagonal or anti-diagonal it is pinned on.
+     */
+    const uint64_t pinned = Legal ? pawns & state.pinned : 0;
+    const uint64_t unpinned = pawns & ~pinned;
+    const uint64_t pushers = unpinned | (pinned & Bitboard::BB_FILES[Bitboard::fileOf(kingSquare)]);
+    const uint64_t diagonalCapturers = unpinned | (pinned & Bitboard::BB_DIAGONALS[Bitboard::diagonalOf(kingSquare)]);
+    const uint64_t antiDiagonalCapturers = unpinned | (pinned & Bitboard::BB_ANTI_DIAGONALS[Bitboard::antiDiagonalOf(kingSquare)]);
+
+    const uint64_t diagonalCaptures = shifted<upDiagonal>(diagonalCapturers) & enemyBb & state.checkmask;
+    const uint64_t antiDiagonalCaptures = shifted<upAntiDiagonal>(antiDiagonalCapturers) & enemyBb & state.checkmask;
+    i += serializePromotions(&moves[i], diagonalCaptures & lastRank, upDiagonal, true);
+    i += serializePromotions(&moves[i], antiDiagonalCaptures & lastRank, upAntiDiagonal, true);
+    i += serializeTargets(&moves[i], diagonalCaptures & ~lastRank, upDiagonal, MoveFlags::CAPTURE);
+    i += serializeTargets(&moves[i], antiDiagonalCaptures & ~lastRank, upAntiDiagonal, MoveFlags::CAPTURE);
+
+    if (Quiets) {
+        const uint64_t thirdRank = Color == WHITE ? Bitboard::BB_RANK_3 : Bitboard::BB_RANK_6;
+        const uint64_t singlePushes = shifted<up>(pushers) & ~this->occupied;
+        const uint64_t doublePushes = shifted<up>(singlePushes & thirdRank) & ~this->occupied & state.checkmask;
+        i += serializePromotions(&moves[i], singlePushes & state.checkmask & lastRank, up, false);
+        i += serializeTargets(&moves[i], singlePushes & state.checkmask & ~lastRank, up, MoveFlags::NONE);
+        i += serializeTargets(&moves[i], doublePushes, 2 * up, MoveFlags::NONE);
+    }
 
-        uint64_t checkmask = this->_get_checkmask(color);
-        uint64_t pos_pinned = this->get_queen_moves(BLACK, king_square) & pieces;
+    if (this->en_passant_square != INVALID) {
+        uint64_t capturers = pawnAttacks<!Color>(Bitboard::BB_SQUARES[this->en_passant_square]) & pawns;
+        while (capturers) {
+            const int from = BitUtils::pullLSB(&capturers);
+            if (Legal && !this->_is_en_passant_legal<Color>(from)) continue;
+            moves[i++] = {(unsigned int) from, (unsigned int) this->en_passant_square, MoveFlags::EN_PASSANT};
+        }
+    }
+    return i;
+}
 
-        pawns = this->wPawns & Bitboard::BB_RANK_7;
-        while (pawns) {
-            int from = BitUtils::pullLSB(&pawns);
+template<bool Color>
+bool Bitboard::_is_en_passant_legal(int from) {
+    /**
+     * En passant removes two pawns from their squares at once, which the pins and checkmask do not
+     * account for, so the king is tested for attackers on the board as it is after the capture.
+     * For example en passant is legal here: 8/8/8/2k5/3Pp3/8/8/3K4 b - d3 0 1
+     * And illegal here: 8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1, k7/1q6/8/3pP3/8/5K2/8/8 w - d6 0 1
+     */
+    const int to = this->en_passant_square;
+    const uint64_t captured_bb = Bitboard::BB_SQUARES[to + (Color == WHITE ? -8 : 8)];
+    const uint64_t occupied = (this->occupied ^ Bitboard::BB_SQUARES[from] ^ captured_bb) | Bitboard::BB_SQUARES[to];
+
+    const int king_square = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+    const uint64_t enemy_pawns = (this->pieces(!Color, PAWN)) & ~captured_bb;
+    const uint64_t enemy_knights = this->pieces(!Color, KNIGHT);
+    const uint64_t enemy_bq_bb = (this->typeBB[BISHOP] | this->typeBB[QUEEN]) & this->colorBB[!Color];
+    const uint64_t enemy_rq_bb = (this->typeBB[ROOK] | this->typeBB[QUEEN]) & this->colorBB[!Color];
+    return !((pawnAttacks<Color>(Bitboard::BB_SQUARES[king_square]) & enemy_pawns) |
+             (MoveGen::BB_KNIGHT_ATTACKS[king_square] & enemy_knights) |
+             (Bitboard::_get_bishop_attacks(king_square, occupied) & enemy_bq_bb) |
+             (Bitboard::_get_rook_attacks(king_square, occupied) & enemy_rq_bb));
+}
 
-            uint64_t pinmask;
-            uint64_t pinned_bb = Bitboard::BB_SQUARES[from] & pos_pinned;
-            if (pinned_bb) {
-                pinmask = _get_pinmask(color, from);
-            } else {
-                pinmask = Bitboard::BB_ALL;
-            }
-            if (!(((Bitboard::BB_SQUARES[from] << 8) & ~(this->occupied)) & checkmask & pinmask)) continue;
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from + 8, MoveFlags::PR_QUEEN, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from + 8, MoveFlags::PR_ROOK, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from + 8, MoveFlags::PR_BISHOP, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from + 8, MoveFlags::PR_KNIGHT, 0};
-        }
-    } else {
-        pieces = this->bOccupied;
-        king_square = this->bKingSquare;
+template<bool Color, bool Legal>
+int Bitboard::_gen_nonquiescent_moves(move_t *moves) {
+    int num_proms = 0;
 
-        uint64_t checkmask = this->_get_checkmask(color);
-        uint64_t pos_pinned = this->get_queen_moves(WHITE, king_square) & pieces;
+    const stateinfo_t state = this->_get_state_of<Color>();
+    const uint64_t checkmask = state.checkmask;
 
-        pawns = this->bPawns & Bitboard::BB_RANK_2;
-        while (pawns) {
-            int from = BitUtils::pullLSB(&pawns);
+    const int king_square = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+    const int push = Color == WHITE ? 8 : -8;
+    uint64_t pawns = this->pieces(Color, PAWN) & (Color == WHITE ? Bitboard::BB_RANK_7 : Bitboard::BB_RANK_2);
+    while (pawns) {
+        int from = BitUtils::pullLSB(&pawns);
+        const unsigned int to = from + push;
 
-            uint64_t pinned_bb = Bitboard::BB_SQUARES[from] & pos_pinned;
-            uint64_t pinmask = pinned_bb ? this->_get_pinmask(color, from) : Bitboard::BB_ALL;
+        uint64_t pinned_bb = Legal ? Bitboard::BB_SQUARES[from] & state.pinned : 0;
+        uint64_t pinmask = pinned_bb ? Bitboard::BB_RAYS[king_square][from] : Bitboard::BB_ALL;
 
-            if (!(((Bitboard::BB_SQUARES[from] >> 8) & ~(this->occupied)) & checkmask & pinmask)) continue;
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from - 8, MoveFlags::PR_QUEEN, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from - 8, MoveFlags::PR_ROOK, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from - 8, MoveFlags::PR_BISHOP, 0};
-            moves[num_proms++] = {(unsigned int) from, (unsigned int) from - 8, MoveFlags::PR_KNIGHT, 0};
-        }
+        if (!(Bitboard::BB_SQUARES[to] & ~(this->occupied) & checkmask & pinmask)) continue;
+        moves[num_proms++] = {(unsigned int) from, to, MoveFlags::PR_QUEEN};
+        moves[num_proms++] = {(unsigned int) from, to, MoveFlags::PR_ROOK};
+        moves[num_proms++] = {(unsigned int) from, to, MoveFlags::PR_BISHOP};
+        moves[num_proms++] = {(unsigned int) from, to, MoveFlags::PR_KNIGHT};
     }
-    int num_captures = this->genLegalCaptures(&(moves[num_proms]), color);
+    int num_captures = this->_gen_captures<Color, Legal>(&(moves[num_proms]));
     return num_proms + num_captures;
 }
 
-/**
- * Updates the board with the move.
- * @param move
- */
-void Bitboard::makeMove(const move_t &move) {
+undo_t Bitboard::makeMove(const move_t &move) {
     int from = move.from;
     int to = move.to;
     int flag = move.flag;
@@ -634,10 +626,25 @@ void Bitboard::makeMove(const move_t &move) {
 
     piece_t attacker = this->mailbox[from];
     piece_t victim = this->mailbox[to];
+
+    undo_t undo;
+    undo.move = move;
+    undo.captured = victim;
+    undo.wKingsideCastleRights = this->wKingsideCastleRights;
+    undo.wQueensideCastleRights = this->wQueensideCastleRights;
+    undo.bKingsideCastleRights = this->bKingsideCastleRights;
+    undo.bQueensideCastleRights = this->bQueensideCastleRights;
+    undo.en_passant_square = this->en_passant_square;
+    undo.halfmove_clock = this->halfmove_clock;
+    undo.hash_code = this->hash_code;
+    undo.state = this->state;
+    undo.stateValid = this->stateValid;
+    this->stateValid = false;
+
     if (flag == PASS) {
         this->turn = !color;
         this->hash_code ^= Bitboard::ZOBRIST_VALUES[768];
-        return;
+        return undo;
     }
 
     bool reset_halfmove = false;
@@ -645,11 +652,26 @@ void Bitboard::makeMove(const move_t &move) {
         this->hash_code ^= Bitboard::ZOBRIST_VALUES[773 + Bitboard::fileOf(this->en_passant_square)];
         this->en_passant_square = INVALID;
     }
-    uint64_t *attacker_bb = this->getBitboard(attacker);
-    BitUtils::clearBit(attacker_bb, from);
-    BitUtils::setBit(attacker_bb, to);
-    this->mailbox[from] = piece_t::EMPTY;
-    this->mailbox[to] = attacker;
+    if (victim != piece_t::EMPTY) {
+        reset_halfmove = true;
+        this->_remove_piece(to);
+        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) victim + to];
+        /** Capturing a rook on its home square revokes the corresponding castling rights */
+        if (to == Squares::H1 && this->wKingsideCastleRights) {
+            this->wKingsideCastleRights = false;
+            this->hash_code ^= Bitboard::ZOBRIST_VALUES[769];
+        } else if (to == Squares::A1 && this->wQueensideCastleRights) {
+            this->wQueensideCastleRights = false;
+            this->hash_code ^= Bitboard::ZOBRIST_VALUES[770];
+        } else if (to == Squares::H8 && this->bKingsideCastleRights) {
+            this->bKingsideCastleRights = false;
+            this->hash_code ^= Bitboard::ZOBRIST_VALUES[771];
+        } else if (to == Squares::A8 && this->bQueensideCastleRights) {
+            this->bQueensideCastleRights = false;
+            this->hash_code ^= Bitboard::ZOBRIST_VALUES[772];
+        }
+    }
+    this->_move_piece(from, to);
     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) attacker + from];
     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) attacker + to];
 
@@ -660,34 +682,15 @@ void Bitboard::makeMove(const move_t &move) {
                 this->en_passant_square = to - 8;
                 this->hash_code ^= Bitboard::ZOBRIST_VALUES[773 + Bitboard::fileOf(this->en_passant_square)];
             } else if (flag == MoveFlags::EN_PASSANT) {
-                BitUtils::clearBit(&this->bPawns, to - 8);
-                this->mailbox[to - 8] = EMPTY;
+                this->_remove_piece(to - 8);
                 this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * BLACK_PAWN + (to - 8)];
             } else if (Bitboard::rankOf(to) == 7) { // Promotions
-                BitUtils::clearBit(&this->wPawns, to);
-                this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * WHITE_PAWN + to];
-                switch (flag) {
-                    case PR_QUEEN:
-                        BitUtils::setBit(&this->wQueens, to);
-                        this->mailbox[to] = WHITE_QUEEN;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * WHITE_QUEEN + to];
-                        break;
-                    case PR_ROOK:
-                        BitUtils::setBit(&this->wRooks, to);
-                        this->mailbox[to] = WHITE_ROOK;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * WHITE_ROOK + to];
-                        break;
-                    case PR_BISHOP:
-                        BitUtils::setBit(&this->wBishops, to);
-                        this->mailbox[to] = WHITE_BISHOP;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * WHITE_BISHOP + to];
-                        break;
-                    case PR_KNIGHT:
-                        BitUtils::setBit(&this->wKnights, to);
-                        this->mailbox[to] = WHITE_KNIGHT;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * WHITE_KNIGHT + to];
-                        break;
-                }
+                this->_remove_piece(to);
+                this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_PAWN + to];
+                /** The promotion flags list the pieces in the order of piece_t */
+                piece_t promoted = static_cast<piece_t> (piece_t::WHITE_KNIGHT + (flag - MoveFlags::PR_KNIGHT) % 4);
+                this->_put_piece(promoted, to);
+                this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) promoted + to];
             }
             break;
         case piece_t::WHITE_ROOK:
@@ -703,17 +706,11 @@ void Bitboard::makeMove(const move_t &move) {
             this->wKingSquare = to;
             if (flag == MoveFlags::CASTLING) {
                 if (Bitboard::fileOf(to) - Bitboard::fileOf(from) > 0) { // Kingside
-                    BitUtils::clearBit(&this->wRooks, Squares::H1);
-                    BitUtils::setBit(&this->wRooks, Squares::F1);
-                    this->mailbox[H1] = piece_t::EMPTY;
-                    this->mailbox[F1] = piece_t::WHITE_ROOK;
+                    this->_move_piece(Squares::H1, Squares::F1);
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_ROOK + Squares::H1];
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_ROOK + Squares::F1];
                 } else { // Queenside
-                    BitUtils::clearBit(&this->wRooks, Squares::A1);
-                    BitUtils::setBit(&this->wRooks, Squares::D1);
-                    this->mailbox[Squares::A1] = piece_t::EMPTY;
-                    this->mailbox[Squares::D1] = piece_t::WHITE_ROOK;
+                    this->_move_piece(Squares::A1, Squares::D1);
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_ROOK + Squares::A1];
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_ROOK + Squares::D1];
                 }
@@ -734,34 +731,14 @@ void Bitboard::makeMove(const move_t &move) {
                 this->en_passant_square = to + 8;
                 this->hash_code ^= Bitboard::ZOBRIST_VALUES[773 + Bitboard::fileOf(this->en_passant_square)];
             } else if (flag == MoveFlags::EN_PASSANT) {
-                BitUtils::clearBit(&this->wPawns, to + 8);
-                this->mailbox[to + 8] = piece_t::EMPTY;
+                this->_remove_piece(to + 8);
                 this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::WHITE_PAWN + (to + 8)];
             } else if (Bitboard::rankOf(to) == 0) { // Promotions
-                BitUtils::clearBit(&this->bPawns, to);
+                this->_remove_piece(to);
                 this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_PAWN + to];
-                switch (flag) {
-                    case MoveFlags::PR_QUEEN:
-                        BitUtils::setBit(&this->bQueens, to);
-                        this->mailbox[to] = piece_t::BLACK_QUEEN;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_QUEEN + to];
-                        break;
-                    case MoveFlags::PR_ROOK:
-                        BitUtils::setBit(&this->bRooks, to);
-                        this->mailbox[to] = piece_t::BLACK_ROOK;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_ROOK + to];
-                        break;
-                    case MoveFlags::PR_BISHOP:
-                        BitUtils::setBit(&this->bBishops, to);
-                        this->mailbox[to] = piece_t::BLACK_BISHOP;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_BISHOP + to];
-                        break;
-                    case MoveFlags::PR_KNIGHT:
-                        BitUtils::setBit(&this->bKnights, to);
-                        this->mailbox[to] = piece_t::BLACK_KNIGHT;
-                        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_KNIGHT + to];
-                        break;
-                }
+                piece_t promoted = static_cast<piece_t> (piece_t::BLACK_KNIGHT + (flag - MoveFlags::PR_KNIGHT) % 4);
+                this->_put_piece(promoted, to);
+                this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) promoted + to];
             }
             break;
         case piece_t::BLACK_ROOK:
@@ -777,17 +754,11 @@ void Bitboard::makeMove(const move_t &move) {
             this->bKingSquare = to;
             if (flag == MoveFlags::CASTLING) {
                 if (Bitboard::fileOf(to) - Bitboard::fileOf(from) > 0) { // Kingside
-                    BitUtils::clearBit(&this->bRooks, Squares::H8);
-                    BitUtils::setBit(&this->bRooks, Squares::F8);
-                    this->mailbox[Squares::H8] = piece_t::EMPTY;
-                    this->mailbox[Squares::F8] = piece_t::BLACK_ROOK;
+                    this->_move_piece(Squares::H8, Squares::F8);
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_ROOK + Squares::H8];
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_ROOK + Squares::F8];
                 } else { // Queenside
-                    BitUtils::clearBit(&this->bRooks, Squares::A8);
-                    BitUtils::setBit(&this->bRooks, Squares::D8);
-                    this->mailbox[Squares::A8] = piece_t::EMPTY;
-                    this->mailbox[Squares::D8] = piece_t::BLACK_ROOK;
+                    this->_move_piece(Squares::A8, Squares::D8);
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_ROOK + Squares::A8];
                     this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * piece_t::BLACK_ROOK + Squares::D8];
                 }
@@ -803,38 +774,6 @@ void Bitboard::makeMove(const move_t &move) {
             }
             break;
     }
-    if (victim != piece_t::EMPTY) {
-        reset_halfmove = true;
-        uint64_t *victim_bb = this->getBitboard(victim);
-        BitUtils::clearBit(victim_bb, to);
-        this->hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) victim + to];
-        if (this->wKingsideCastleRights) {
-            if (to == Squares::H1) {
-                this->wKingsideCastleRights = false;
-                this->hash_code ^= Bitboard::ZOBRIST_VALUES[769];
-            }
-        } else if (this->wQueensideCastleRights) {
-            if (to == Squares::A1) {
-                this->wQueensideCastleRights = false;
-                this->hash_code ^= Bitboard::ZOBRIST_VALUES[770];
-            }
-        } else if (this->bQueensideCastleRights) {
-            if (to == Squares::A8) {
-                this->bQueensideCastleRights = false;
-                this->hash_code ^= Bitboard::ZOBRIST_VALUES[771];
-            }
-        } else if (this->bKingsideCastleRights) {
-            if (to == Squares::H8) {
-                this->bKingsideCastleRights = false;
-                this->hash_code ^= Bitboard::ZOBRIST_VALUES[772];
-            }
-        }
-    }
-    this->wOccupied =
-            this->wPawns | this->wKnights | this->wBishops | this->wRooks | this->wQueens | this->wKing;
-    this->bOccupied =
-            this->bPawns | this->bKnights | this->bBishops | this->bRooks | this->bQueens | this->bKing;
-    this->occupied = this->wOccupied | this->bOccupied;
     if (reset_halfmove) {
         this->halfmove_clock = 0;
     } else {
@@ -843,6 +782,61 @@ void Bitboard::makeMove(const move_t &move) {
     this->turn = !color;
     this->fullmove_number += color;
     this->hash_code ^= Bitboard::ZOBRIST_VALUES[768];
+    return undo;
+}
+
+void Bitboard::unmakeMove(const undo_t &undo) {
+    int from = undo.move.from;
+    int to = undo.move.to;
+    int flag = undo.move.flag;
+    bool color = !this->turn;
+
+    this->turn = color;
+    this->hash_code = undo.hash_code;
+    this->state = undo.state;
+    this->stateValid = undo.stateValid;
+    if (flag == PASS) {
+        return;
+    }
+
+    piece_t moved = this->mailbox[to];
+    if (flag >= MoveFlags::PR_KNIGHT) {
+        moved = color == WHITE ? piece_t::WHITE_PAWN : piece_t::BLACK_PAWN;
+        this->_remove_piece(to);
+        this->_put_piece(moved, from);
+    } else {
+        this->_move_piece(to, from);
+    }
+    if (undo.captured != piece_t::EMPTY) {
+        this->_put_piece(undo.captured, to);
+    }
+
+    if (flag == MoveFlags::EN_PASSANT) {
+        if (color == WHITE) {
+            this->_put_piece(piece_t::BLACK_PAWN, to - 8);
+        } else {
+            this->_put_piece(piece_t::WHITE_PAWN, to + 8);
+        }
+    } else if (flag == MoveFlags::CASTLING) {
+        /** Rook squares relative to the king's home square */
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = to > from ? from + 1 : from - 1;
+        this->_move_piece(rookTo, rookFrom);
+    }
+
+    if (moved == piece_t::WHITE_KING) {
+        this->wKingSquare = from;
+    } else if (moved == piece_t::BLACK_KING) {
+        this->bKingSquare = from;
+    }
+
+    this->wKingsideCastleRights = undo.wKingsideCastleRights;
+    this->wQueensideCastleRights = undo.wQueensideCastleRights;
+    this->bKingsideCastleRights = undo.bKingsideCastleRights;
+    this->bQueensideCastleRights = undo.bQueensideCastleRights;
+    this->en_passant_square = undo.en_passant_square;
+    this->halfmove_clock = undo.halfmove_clock;
+    this->fullmove_number -= color;
 }
 
 move_t Bitboard::parseMove(const std::string &mv_str) {
@@ -880,21 +874,137 @@ move_t Bitboard::parseMove(const std::string &mv_str) {
 }
 
 bool Bitboard::isInCheck(bool color) {
+    if (color == this->turn && this->stateValid) {
+        return this->state.checkers != 0;
+    }
     if (color == WHITE) {
-        return this->isAttacked(BLACK, BitUtils::getLSB(this->wKing));
+        return this->isAttacked(BLACK, BitUtils::getLSB(this->pieces(WHITE, KING)));
     } else {
-        return this->isAttacked(WHITE, BitUtils::getLSB(this->bKing));
+        return this->isAttacked(WHITE, BitUtils::getLSB(this->pieces(BLACK, KING)));
     }
 }
 
 bool Bitboard::isMoveCheck(const move_t &move) {
-    Bitboard savedBoard = *this;
-    this->makeMove(move);
+    const undo_t undo = this->makeMove(move);
     bool inCheck = this->isInCheck(this->turn);
-    *this = savedBoard;
+    this->unmakeMove(undo);
     return inCheck;
 }
 
+checkinfo_t Bitboard::getCheckInfo() {
+    checkinfo_t ci;
+    const bool color = this->turn;
+    const int king_square = color == WHITE ? this->bKingSquare : this->wKingSquare;
+    const uint64_t pieces = this->colorBB[color];
+    ci.kingSquare = king_square;
+
+    /** A piece checks from the squares the same piece type would attack from the king square */
+    ci.checkSquares[piece_t::BLACK_PAWN] = MoveGen::get_pawn_attacks_setwise(Bitboard::BB_SQUARES[king_square], !color);
+    ci.checkSquares[piece_t::BLACK_KNIGHT] = MoveGen::BB_KNIGHT_ATTACKS[king_square];
+    ci.checkSquares[piece_t::BLACK_BISHOP] = Bitboard::_get_bishop_attacks(king_square, this->occupied) & ~pieces;
+    ci.checkSquares[piece_t::BLACK_ROOK] = Bitboard::_get_rook_attacks(king_square, this->occupied) & ~pieces;
+    ci.checkSquares[piece_t::BLACK_QUEEN] = ci.checkSquares[piece_t::BLACK_BISHOP] | ci.checkSquares[piece_t::BLACK_ROOK];
+    ci.checkSquares[piece_t::BLACK_KING] = 0;
+
+    /** Sliders aligned with the king on an empty board, with exactly one of our own pieces in between */
+    uint64_t rq_bb = (this->typeBB[ROOK] | this->typeBB[QUEEN]) & this->colorBB[color];
+    uint64_t bq_bb = (this->typeBB[BISHOP] | this->typeBB[QUEEN]) & this->colorBB[color];
+    uint64_t snipers = (Bitboard::_get_rook_attacks(king_square, 0) & rq_bb) | (Bitboard::_get_bishop_attacks(king_square, 0) & bq_bb);
+    uint64_t pinners;
+    ci.discoverers = this->_get_blockers(king_square, snipers, pieces, &pinners);
+    return ci;
+}
+
+bool Bitboard::givesCheck(const move_t &move, const checkinfo_t &ci) {
+    const int from = move.from;
+    const int to = move.to;
+    /** Castling, en passant and promotions move or remove a second piece, so they take the slow path */
+    if (move.flag == MoveFlags::CASTLING || move.flag == MoveFlags::EN_PASSANT || move.flag >= MoveFlags::PR_KNIGHT) {
+        return this->isMoveCheck(move);
+    }
+    if (ci.checkSquares[this->mailbox[from] % 6] & Bitboard::BB_SQUARES[to]) {
+        return true;
+    }
+    /** A discoverer checks unless it stays on the line to the king */
+    return (ci.discoverers & Bitboard::BB_SQUARES[from]) && !(Bitboard::BB_RAYS[from][ci.kingSquare] & Bitboard::BB_SQUARES[to]);
+}
+
+/**
+ * Validates a move that was not generated in this position, such as a transposition table or killer move.
+ * @param move the move to validate.
+ * @return whether the move is legal for the side to move.
+ */
+bool Bitboard::isMoveLegal(const move_t &move) {
+    return this->turn == WHITE ? this->_is_move_legal<WHITE>(move) : this->_is_move_legal<BLACK>(move);
+}
+
+template<bool Color>
+bool Bitboard::_is_move_legal(const move_t &move) {
+    const int from = move.from;
+    const int to = move.to;
+    const piece_t piece = this->mailbox[from];
+    if (move.flag == MoveFlags::PASS || piece == piece_t::EMPTY || (piece >= piece_t::WHITE_PAWN) != Color) {
+        return false;
+    }
+
+    const piece_t type = static_cast<piece_t> (piece % 6);
+    uint64_t moves_bb;
+    switch (type) {
+        case piece_t::BLACK_PAWN:
+            moves_bb = this->get_pawn_moves<Color>(from);
+            break;
+        case piece_t::BLACK_KNIGHT:
+            moves_bb = this->get_knight_moves<Color>(from);
+            break;
+        case piece_t::BLACK_BISHOP:
+            moves_bb = this->get_bishop_moves<Color>(from);
+            break;
+        case piece_t::BLACK_ROOK:
+            moves_bb = this->get_rook_moves<Color>(from);
+            break;
+        case piece_t::BLACK_QUEEN:
+            moves_bb = this->get_queen_moves<Color>(from);
+            break;
+        default:
+            moves_bb = this->get_king_moves<Color>(from);
+            break;
+    }
+    if (!(moves_bb & Bitboard::BB_SQUARES[to])) {
+        return false;
+    }
+
+    if (type == piece_t::BLACK_PAWN && (Bitboard::rankOf(to) == 0 || Bitboard::rankOf(to) == 7)) {
+        const bool capture = this->mailbox[to] != piece_t::EMPTY;
+        if (move.flag < (capture ? MoveFlags::PC_KNIGHT : MoveFlags::PR_KNIGHT) ||
+            move.flag > (capture ? MoveFlags::PC_QUEEN : MoveFlags::PR_QUEEN)) {
+            return false;
+        }
+    } else if (move.flag != this->getFlag(type, from, to)) {
+        return false;
+    }
+
+    const stateinfo_t &state = this->getStateInfo();
+    if (move.flag == MoveFlags::CASTLING) {
+        return this->canCastle<Color>(from, to, state.attackmask);
+    }
+    if (type == piece_t::BLACK_KING) {
+        return !(state.attackmask & Bitboard::BB_SQUARES[to]);
+    }
+    if (move.flag != MoveFlags::EN_PASSANT && !(state.checkmask & Bitboard::BB_SQUARES[to])) {
+        return false;
+    }
+    return this->isLegal(move);
+}
+
+bool Bitboard::isLegal(const move_t &move) {
+    if (move.flag == MoveFlags::EN_PASSANT) {
+        return this->turn == WHITE ? this->_is_en_passant_legal<WHITE>(move.from) : this->_is_en_passant_legal<BLACK>(move.from);
+    }
+    const int king_square = this->turn == WHITE ? this->wKingSquare : this->bKingSquare;
+    return !(this->getStateInfo().pinned & Bitboard::BB_SQUARES[move.from]) ||
+           (Bitboard::BB_RAYS[king_square][move.from] & Bitboard::BB_SQUARES[move.to]);
+}
+
 /**
  * @param color the color of the attackers.
  * @param square the square potentially being attacked.
@@ -903,19 +1013,21 @@ bool Bitboard::isMoveCheck(const move_t &move) {
 bool Bitboard::isAttacked(bool color, int square) {
     if (color == BLACK) {
         uint64_t square_bb = Bitboard::BB_SQUARES[square];
-        if (this->get_queen_moves(WHITE, square) & this->bQueens) return true;
-        if (this->get_rook_moves(WHITE, square) & this->bRooks) return true;
-        if (this->get_bishop_moves(WHITE, square) & this->bBishops) return true;
-        if (this->get_knight_moves(WHITE, square) & this->bKnights) return true;
-        if ((((square_bb << 9) & ~BB_FILE_A) | ((square_bb << 7) & ~BB_FILE_H)) & this->bPawns) return true;
+        if (this->get_queen_moves<WHITE>(square) & this->pieces(BLACK, QUEEN)) return true;
+        if (this->get_rook_moves<WHITE>(square) & this->pieces(BLACK, ROOK)) return true;
+        if (this->get_bishop_moves<WHITE>(square) & this->pieces(BLACK, BISHOP)) return true;
+        if (this->get_knight_moves<WHITE>(square) & this->pieces(BLACK, KNIGHT)) return true;
+        if ((((square_bb << 9) & ~BB_FILE_A) | ((square_bb << 7) & ~BB_FILE_H)) & this->pieces(BLACK, PAWN)) return true;
+        if (MoveGen::BB_KING_ATTACKS[square] & this->pieces(BLACK, KING)) return true;
         return false;
     } else {
         uint64_t square_bb = Bitboard::BB_SQUARES[square];
-        if (this->get_queen_moves(BLACK, square) & this->wQueens) return true;
-        if (this->get_rook_moves(BLACK, square) & this->wRooks) return true;
-        if (this->get_bishop_moves(BLACK, square) & this->wBishops) return true;
-        if (this->get_knight_moves(BLACK, square) & this->wKnights) return true;
-        if ((((square_bb >> 9) & ~BB_FILE_H) | ((square_bb >> 7) & ~BB_FILE_A)) & this->wPawns) return true;
+        if (this->get_queen_moves<BLACK>(square) & this->pieces(WHITE, QUEEN)) return true;
+        if (this->get_rook_moves<BLACK>(square) & this->pieces(WHITE, ROOK)) return true;
+        if (this->get_bishop_moves<BLACK>(square) & this->pieces(WHITE, BISHOP)) return true;
+        if (this->get_knight_moves<BLACK>(square) & this->pieces(WHITE, KNIGHT)) return true;
+        if ((((square_bb >> 9) & ~BB_FILE_H) | ((square_bb >> 7) & ~BB_FILE_A)) & this->pieces(WHITE, PAWN)) return true;
+        if (MoveGen::BB_KING_ATTACKS[square] & this->pieces(WHITE, KING)) return true;
         return false;
     }
 }
@@ -924,14 +1036,14 @@ bool Bitboard::containsPromotions() {
     uint64_t promotionSquares;
     if (turn) {
         /** Checks if white has any pawn promotions */
-        promotionSquares = ((this->wPawns & Bitboard::BB_RANK_7) << 8) & ~(this->occupied);
-        promotionSquares |= ((((this->wPawns << 9) & ~Bitboard::BB_FILE_A) | ((this->wPawns << 7) & ~Bitboard::BB_FILE_H)) & Bitboard::BB_RANK_8) &
-                        this->bOccupied;
+        promotionSquares = ((this->pieces(WHITE, PAWN) & Bitboard::BB_RANK_7) << 8) & ~(this->occupied);
+        promotionSquares |= ((((this->pieces(WHITE, PAWN) << 9) & ~Bitboard::BB_FILE_A) | ((this->pieces(WHITE, PAWN) << 7) & ~Bitboard::BB_FILE_H)) & Bitboard::BB_RANK_8) &
+                        this->colorBB[BLACK];
     } else {
         /** Checks if black has any pawn promotions */
-        promotionSquares = ((this->bPawns & Bitboard::BB_RANK_2) >> 8) & ~(this->occupied);
-        promotionSquares |= ((((this->bPawns >> 9) & ~Bitboard::BB_FILE_H) | ((this->bPawns >> 7) & ~Bitboard::BB_FILE_A)) & Bitboard::BB_RANK_1) &
-                        this->wOccupied;
+        promotionSquares = ((this->pieces(BLACK, PAWN) & Bitboard::BB_RANK_2) >> 8) & ~(this->occupied);
+        promotionSquares |= ((((this->pieces(BLACK, PAWN) >> 9) & ~Bitboard::BB_FILE_H) | ((this->pieces(BLACK, PAWN) >> 7) & ~Bitboard::BB_FILE_A)) & Bitboard::BB_RANK_1) &
+                        this->colorBB[WHITE];
     }
     return BitUtils::popCount(promotionSquares) > 0;
 }
@@ -941,35 +1053,18 @@ int32_t Bitboard::pieceValue(int square) {
     return (1 - (piece == piece_t::EMPTY)) * SearchContext::pieceValue(piece);
 }
 
-uint64_t Bitboard::findLVA(uint64_t attadef, piece_t &piece, uint64_t target) {
+/**
+ * @param attackers the pieces that may capture next.
+ * @param piece set to the least valuable of them.
+ * @return the square of the least valuable attacker, or an empty bitboard if there are none.
+ */
+uint64_t Bitboard::findLVA(uint64_t attackers, piece_t &piece) {
     int32_t min_piece_value = INT32_MAX;
     uint64_t lva_bb = 0ULL;
 
-    uint64_t pieces;
-    uint64_t king_bb;
-    int king_square;
-    if (this->turn) {
-        pieces = this->wOccupied;
-        king_bb = this->wKing;
-        king_square = this->wKingSquare;
-    } else {
-        pieces = this->bOccupied;
-        king_bb = this->bKing;
-        king_square = this->bKingSquare;
-    }
-
-    uint64_t attackmask = this->_get_attackmask(!(this->turn));
-    uint64_t checkmask = this->_get_checkmask(this->turn);
-    uint64_t posPinned = this->get_queen_moves(!(this->turn), king_square) & pieces;
-
-    while (attadef) {
-        int i = BitUtils::pullLSB(&attadef), value;
-
-        uint64_t pinned_bb = Bitboard::BB_SQUARES[i] & posPinned;
-        uint64_t pinmask = (pinned_bb) ? this->_get_pinmask(this->turn, i) : Bitboard::BB_ALL;
-        
-        if ((static_cast<int> (this->mailbox[i]) / 6) == this->turn &&
-            (value = pieceValue(this->mailbox[i])) < min_piece_value && target & checkmask & pinmask) {
+    while (attackers) {
+        int i = BitUtils::pullLSB(&attackers), value;
+        if ((value = SearchContext::pieceValue(this->mailbox[i])) < min_piece_value) {
             min_piece_value = value;
 
             lva_bb = Bitboard::BB_SQUARES[i];
@@ -979,24 +1074,48 @@ uint64_t Bitboard::findLVA(uint64_t attadef, piece_t &piece, uint64_t target) {
     return lva_bb;
 }
 
-uint64_t Bitboard::_get_attackmask(bool color) {
-    uint64_t occupied;
-    uint64_t key;
+/**
+ * BMI2 parallel bit extract, emitted directly so that the lookups below need no per-function target
+ * attribute. Only executed once MoveGen has confirmed the CPU supports it.
+ */
+static inline uint64_t pext(uint64_t src, uint64_t mask) {
+#if defined(__x86_64__) && defined(__GNUC__)
+    uint64_t result;
+    asm("pext %2, %1, %0" : "=r" (result) : "r" (src), "r" (mask));
+    return result;
+#else
+    return 0;
+#endif
+}
 
-    uint64_t moves_bb;
-    uint64_t pieces;
-    int king_square;
-    if (color == WHITE) {
-        pieces = this->wOccupied & ~this->wPawns;
-        king_square = this->bKingSquare;
-        moves_bb = (((this->wPawns << 9) & ~Bitboard::BB_FILE_A) | ((this->wPawns << 7) & ~Bitboard::BB_FILE_H));
-    } else {
-        pieces = this->bOccupied & ~this->bPawns;
-        king_square = this->wKingSquare;
-        moves_bb = (((this->bPawns >> 9) & ~Bitboard::BB_FILE_H) | ((this->bPawns >> 7) & ~Bitboard::BB_FILE_A));
+uint64_t Bitboard::_get_rook_attacks(int square, uint64_t occupied) {
+    if (MoveGen::PEXT_ENABLED) {
+        const slider_attacks_t<102400> &table = MoveGen::ROOK_PEXT_ATTACKS;
+        return table.attacks[table.offsets[square] + pext(occupied, table.masks[square])];
     }
+    const slider_attacks_t<102400> &table = MoveGen::ROOK_ATTACKS;
+    uint64_t key = ((occupied & table.masks[square]) * MoveGen::ROOK_MAGICS[square]) >> table.shifts[square];
+    return table.attacks[table.offsets[square] + key];
+}
 
-    BitUtils::clearBit(&this->occupied, king_square);
+uint64_t Bitboard::_get_bishop_attacks(int square, uint64_t occupied) {
+    if (MoveGen::PEXT_ENABLED) {
+        const slider_attacks_t<5248> &table = MoveGen::BISHOP_PEXT_ATTACKS;
+        return table.attacks[table.offsets[square] + pext(occupied, table.masks[square])];
+    }
+    const slider_attacks_t<5248> &table = MoveGen::BISHOP_ATTACKS;
+    uint64_t key = ((occupied & table.masks[square]) * MoveGen::BISHOP_MAGICS[square]) >> table.shifts[square];
+    return table.attacks[table.offsets[square] + key];
+}
+
+template<bool Color>
+uint64_t Bitboard::_get_attackmask() {
+    uint64_t pieces = this->colorBB[Color] & ~this->typeBB[PAWN];
+    const int king_square = Color == WHITE ? this->bKingSquare : this->wKingSquare;
+    uint64_t moves_bb = pawnAttacks<Color>(this->pieces(Color, PAWN));
+
+    /** Sliders see through the enemy king, so it can't step back along the line of a check */
+    const uint64_t occupied = this->occupied & ~Bitboard::BB_SQUARES[king_square];
 
     while (pieces) {
         int square = BitUtils::pullLSB(&pieces);
@@ -1006,132 +1125,126 @@ uint64_t Bitboard::_get_attackmask(bool color) {
                 moves_bb |= MoveGen::BB_KNIGHT_ATTACKS[square];
                 break;
             case piece_t::BLACK_BISHOP:
-                occupied = this->occupied & MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-                key = (occupied * MoveGen::BISHOP_MAGICS[square]) >> MoveGen::BISHOP_ATTACK_SHIFTS[square];
-                moves_bb |= MoveGen::BB_BISHOP_ATTACKS[square][key];
+                moves_bb |= Bitboard::_get_bishop_attacks(square, occupied);
                 break;
             case piece_t::BLACK_ROOK:
-                occupied = this->occupied & MoveGen::BB_ROOK_ATTACK_MASKS[square];
-                key = (occupied * MoveGen::ROOK_MAGICS[square]) >> MoveGen::ROOK_ATTACK_SHIFTS[square];
-                moves_bb |= MoveGen::BB_ROOK_ATTACKS[square][key];
+                moves_bb |= Bitboard::_get_rook_attacks(square, occupied);
                 break;
             case piece_t::BLACK_QUEEN:
-                occupied = this->occupied & MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-                key = (occupied * MoveGen::BISHOP_MAGICS[square]) >> MoveGen::BISHOP_ATTACK_SHIFTS[square];
-                moves_bb |= MoveGen::BB_BISHOP_ATTACKS[square][key];
-
-                occupied = this->occupied & MoveGen::BB_ROOK_ATTACK_MASKS[square];
-                key = (occupied * MoveGen::ROOK_MAGICS[square]) >> MoveGen::ROOK_ATTACK_SHIFTS[square];
-                moves_bb |= MoveGen::BB_ROOK_ATTACKS[square][key];
+                moves_bb |= Bitboard::_get_bishop_attacks(square, occupied) | Bitboard::_get_rook_attacks(square, occupied);
                 break;
             case piece_t::BLACK_KING:
                 moves_bb |= MoveGen::BB_KING_ATTACKS[square];
                 break;
+            default:
+                break;
         }
     }
-    BitUtils::setBit(&this->occupied, king_square);
     return moves_bb;
 }
 
-uint64_t Bitboard::_get_checkmask(bool color) {
-    int num_attackers = 0;
-    uint64_t checkmask = 0;
-
-    int king_square;
-    uint64_t enemy_bq_bb;
-    uint64_t enemy_rq_bb;
-    uint64_t enemy_knight_bb;
-    uint64_t pawns;
-    if (color == WHITE) {
-        king_square = this->wKingSquare;
-        enemy_bq_bb = this->bBishops | this->bQueens;
-        enemy_rq_bb = this->bRooks | this->bQueens;
-        enemy_knight_bb = this->bKnights;
-        pawns = ((((this->wKing << 9) & ~Bitboard::BB_FILE_A) | ((this->wKing << 7) & ~Bitboard::BB_FILE_H))
-                 & this->bPawns);
-    } else {
-        king_square = this->bKingSquare;
-        enemy_bq_bb = this->wBishops | this->wQueens;
-        enemy_rq_bb = this->wRooks | this->wQueens;
-        enemy_knight_bb = this->wKnights;
-        pawns = ((((this->bKing >> 9) & ~Bitboard::BB_FILE_H) | ((this->bKing >> 7) & ~Bitboard::BB_FILE_A))
-                 & this->wPawns);
-    }
-
-    num_attackers += BitUtils::popCount(pawns);
-    if (num_attackers >= 2) {
-        return 0;
-    }
-    checkmask |= pawns;
-
-    uint64_t rq = this->get_rook_moves(color, king_square) & enemy_rq_bb;
-    num_attackers += BitUtils::popCount(rq);
-    if (num_attackers >= 2) {
-        return 0;
-    }
-    while (rq) {
-        int rq_square = BitUtils::pullLSB(&rq);
-        checkmask |= Bitboard::getRayBetween(king_square, rq_square);
-    }
-
-    uint64_t bq = this->get_bishop_moves(color, king_square) & enemy_bq_bb;
-    num_attackers += BitUtils::popCount(bq);
-    if (num_attackers >= 2) {
-        return 0;
-    }
-    while (bq) {
-        int bq_square = BitUtils::pullLSB(&bq);
-        checkmask |= Bitboard::getRayBetween(king_square, bq_square);
-    }
-
-    uint64_t knights = this->get_knight_moves(color, king_square) & enemy_knight_bb;
-    num_attackers += BitUtils::popCount(knights);
-    if (num_attackers >= 2) {
-        return 0;
+uint64_t Bitboard::_get_blockers(int square, uint64_t snipers, uint64_t pieces, uint64_t *pinners) {
+    uint64_t blockers = 0;
+    *pinners = 0;
+    while (snipers) {
+        int sniper_square = BitUtils::pullLSB(&snipers);
+        uint64_t between = Bitboard::getRayBetween(square, sniper_square) & ~Bitboard::BB_SQUARES[square] &
+                           ~Bitboard::BB_SQUARES[sniper_square] & this->occupied;
+        if (between && !(between & (between - 1)) && (between & pieces)) {
+            blockers |= between;
+            *pinners |= Bitboard::BB_SQUARES[sniper_square];
+        }
     }
-    checkmask |= knights;
-
-    if (num_attackers == 0) return Bitboard::BB_ALL;
-    return checkmask;
+    return blockers;
 }
 
-uint64_t Bitboard::_get_pinmask(bool color, int square) {
-    uint64_t pinmask = 0;
-
-    int king_square;
-    uint64_t enemy_rq_bb;
-    uint64_t enemy_bq_bb;
-    if (color == WHITE) {
-        king_square = this->wKingSquare;
-        enemy_rq_bb = this->bRooks | this->bQueens;
-        enemy_bq_bb = this->bBishops | this->bQueens;
+template<bool Color>
+stateinfo_t Bitboard::_get_state() {
+    stateinfo_t state;
+
+    const int king_square = Color == WHITE ? this->wKingSquare : this->bKingSquare;
+    const uint64_t pieces = this->colorBB[Color];
+    const uint64_t enemy_pawns = this->pieces(!Color, PAWN);
+    const uint64_t enemy_knights = this->pieces(!Color, KNIGHT);
+    const uint64_t enemy_bq_bb = (this->typeBB[BISHOP] | this->typeBB[QUEEN]) & this->colorBB[!Color];
+    const uint64_t enemy_rq_bb = (this->typeBB[ROOK] | this->typeBB[QUEEN]) & this->colorBB[!Color];
+
+    state.checkers = (pawnAttacks<Color>(Bitboard::BB_SQUARES[king_square]) & enemy_pawns) |
+                     (MoveGen::BB_KNIGHT_ATTACKS[king_square] & enemy_knights) |
+                     (Bitboard::_get_bishop_attacks(king_square, this->occupied) & enemy_bq_bb) |
+                     (Bitboard::_get_rook_attacks(king_square, this->occupied) & enemy_rq_bb);
+    if (!state.checkers) {
+        state.checkmask = Bitboard::BB_ALL;
+    } else if (!(state.checkers & (state.checkers - 1))) {
+        state.checkmask = Bitboard::getRayBetween(king_square, BitUtils::getLSB(state.checkers));
     } else {
-        king_square = this->bKingSquare;
-        enemy_rq_bb = this->wRooks | this->wQueens;
-        enemy_bq_bb = this->wBishops | this->wQueens;
+        state.checkmask = 0;
     }
 
-    uint64_t occupied = this->occupied & MoveGen::BB_ROOK_ATTACK_MASKS[square];
-    uint64_t key = (occupied * MoveGen::ROOK_MAGICS[square]) >> MoveGen::ROOK_ATTACK_SHIFTS[square];
-    uint64_t rook_attacks = MoveGen::BB_ROOK_ATTACKS[square][key];
+    uint64_t snipers = (Bitboard::_get_rook_attacks(king_square, 0) & enemy_rq_bb) |
+                       (Bitboard::_get_bishop_attacks(king_square, 0) & enemy_bq_bb);
+    state.pinned = this->_get_blockers(king_square, snipers, pieces, &state.pinners);
+    state.attackmask = this->_get_attackmask<!Color>();
+    return state;
+}
 
-    occupied = this->occupied & MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-    key = (occupied * MoveGen::BISHOP_MAGICS[square]) >> MoveGen::BISHOP_ATTACK_SHIFTS[square];
-    uint64_t bishop_attacks = MoveGen::BB_BISHOP_ATTACKS[square][key];
+template<bool Color>
+stateinfo_t Bitboard::_get_state_of() {
+    return Color == this->turn ? this->getStateInfo() : this->_get_state<Color>();
+}
 
-    uint64_t direction = Bitboard::getRayBetweenInclusive(king_square, square);
+const stateinfo_t &Bitboard::getStateInfo() {
+    if (!this->stateValid) {
+        this->state = this->turn == WHITE ? this->_get_state<WHITE>() : this->_get_state<BLACK>();
+        this->stateValid = true;
+    }
+    return this->state;
+}
 
-    uint64_t pin = direction & rook_attacks;
-    if (pin & enemy_rq_bb) {
-        pinmask |= pin;
+/**
+ * @tparam Color the side castling.
+ * @param from the square the king is on.
+ * @param to the square the king castles to.
+ * @param attackmask the squares attacked by the other side.
+ * @return whether the king may castle to the square.
+ */
+template<bool Color>
+bool Bitboard::canCastle(int from, int to, uint64_t attackmask) {
+    if (attackmask & (this->pieces(Color, KING))) return false; // Assert the king is not in check
+    if (Color == WHITE) {
+        if (from != Squares::E1) return false; // Assert the king is still alive
+        if (to == Squares::G1) { // Kingside
+            if (!this->wKingsideCastleRights) return false; // Assert king or rook has not moved
+            if (!(this->pieces(WHITE, ROOK) & Bitboard::BB_SQUARES[Squares::H1])) return false; // Assert rook is still alive
+            if (this->occupied & (Bitboard::BB_SQUARES[Squares::F1] | Bitboard::BB_SQUARES[Squares::G1]))
+                return false; // Assert there are no pieces between the king and rook
+            if (attackmask & (Bitboard::BB_SQUARES[F1] | Bitboard::BB_SQUARES[Squares::G1]))
+                return false; // Assert the squares the king moves through are not attacked
+        } else if (to == Squares::C1) { // Queenside
+            if (!this->wQueensideCastleRights) return false;
+            if (!(this->pieces(WHITE, ROOK) & Bitboard::BB_SQUARES[Squares::A1])) return false;
+            if (this->occupied & (Bitboard::BB_SQUARES[Squares::D1] | Bitboard::BB_SQUARES[Squares::C1] | Bitboard::BB_SQUARES[Squares::B1])) return false;
+            if (attackmask & (Bitboard::BB_SQUARES[Squares::D1] | Bitboard::BB_SQUARES[Squares::C1])) return false;
+        } else {
+            return false;
+        }
     } else {
-        pin = direction & bishop_attacks;
-        if (pin & enemy_bq_bb) {
-            pinmask |= pin;
+        if (from != Squares::E8) return false;
+        if (to == Squares::G8) { // Kingside
+            if (!this->bKingsideCastleRights) return false;
+            if (!(this->pieces(BLACK, ROOK) & Bitboard::BB_SQUARES[Squares::H8])) return false;
+            if (this->occupied & (Bitboard::BB_SQUARES[Squares::F8] | Bitboard::BB_SQUARES[Squares::G8])) return false;
+            if (attackmask & (Bitboard::BB_SQUARES[Squares::F8] | Bitboard::BB_SQUARES[Squares::G8])) return false;
+        } else if (to == Squares::C8) { // Queenside
+            if (!this->bQueensideCastleRights) return false;
+            if (!(this->pieces(BLACK, ROOK) & Bitboard::BB_SQUARES[Squares::A8])) return false;
+            if (this->occupied & (Bitboard::BB_SQUARES[Squares::D8] | Bitboard::BB_SQUARES[Squares::C8] | Bitboard::BB_SQUARES[Squares::B8])) return false;
+            if (attackmask & (Bitboard::BB_SQUARES[Squares::D8] | Bitboard::BB_SQUARES[Squares::C8])) return false;
+        } else {
+            return false;
         }
     }
-    if (pinmask) return pinmask;
-    return Bitboard::BB_ALL;
+    return true;
 }
 
 MoveFlags Bitboard::getFlag(piece_t piece, int from, int to) {
@@ -1145,289 +1258,264 @@ MoveFlags Bitboard::getFlag(piece_t piece, int from, int to) {
     return MoveFlags::NONE;
 }
 
-uint64_t Bitboard::get_king_moves(bool color, int square) {
+template<bool Color>
+uint64_t Bitboard::get_king_moves(int square) {
     uint64_t moves = MoveGen::BB_KING_ATTACKS[square];
-    if (color == WHITE) {
+    if (Color == WHITE) {
         if (this->wKingsideCastleRights) BitUtils::setBit(&moves, Squares::G1);
         if (this->wQueensideCastleRights) BitUtils::setBit(&moves, Squares::C1);
-        return moves & ~(this->wOccupied);
+        return moves & ~(this->colorBB[WHITE]);
     } else {
         if (this->bKingsideCastleRights) BitUtils::setBit(&moves, Squares::G8);
         if (this->bQueensideCastleRights) BitUtils::setBit(&moves, Squares::C8);
-        return moves & ~(this->bOccupied);
+        return moves & ~(this->colorBB[BLACK]);
     }
 }
 
-uint64_t Bitboard::get_king_moves_no_castle(bool color, int square) {
-    uint64_t moves = MoveGen::BB_KING_ATTACKS[square];
-    if (color == WHITE) {
-        return moves & ~(this->wOccupied);
-    } else {
-        return moves & ~(this->bOccupied);
-    }
+template<bool Color>
+uint64_t Bitboard::get_king_moves_no_castle(int square) {
+    return MoveGen::BB_KING_ATTACKS[square] & ~(this->colorBB[Color]);
 }
 
-uint64_t Bitboard::get_queen_moves(bool color, int square) {
-    uint64_t bishop_occupied = this->occupied & MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-    uint64_t bishop_key = (bishop_occupied * MoveGen::BISHOP_MAGICS[square]) >> MoveGen::BISHOP_ATTACK_SHIFTS[square];
-    uint64_t bishop_moves = MoveGen::BB_BISHOP_ATTACKS[square][bishop_key];
-
-    uint64_t rook_occupied = this->occupied & MoveGen::BB_ROOK_ATTACK_MASKS[square];
-    uint64_t rook_key = (rook_occupied * MoveGen::ROOK_MAGICS[square]) >> MoveGen::ROOK_ATTACK_SHIFTS[square];
-    uint64_t rook_moves = MoveGen::BB_ROOK_ATTACKS[square][rook_key];
-
-    uint64_t moves = bishop_moves | rook_moves;
-
-    return moves & ~(this->wOccupied * color + this->bOccupied * !color);
+template<bool Color>
+uint64_t Bitboard::get_queen_moves(int square) {
+    uint64_t moves = Bitboard::_get_bishop_attacks(square, this->occupied) | Bitboard::_get_rook_attacks(square, this->occupied);
+    return moves & ~(this->colorBB[Color]);
 }
 
-uint64_t Bitboard::get_rook_moves(bool color, int square) {
-    uint64_t occupied = this->occupied & MoveGen::BB_ROOK_ATTACK_MASKS[square];
-    uint64_t key = (occupied * MoveGen::ROOK_MAGICS[square]) >> MoveGen::ROOK_ATTACK_SHIFTS[square];
-    uint64_t moves = MoveGen::BB_ROOK_ATTACKS[square][key];
-    return moves & ~(this->wOccupied * color + this->bOccupied * !color);
+template<bool Color>
+uint64_t Bitboard::get_rook_moves(int square) {
+    uint64_t moves = Bitboard::_get_rook_attacks(square, this->occupied);
+    return moves & ~(this->colorBB[Color]);
 }
 
-uint64_t Bitboard::get_bishop_moves(bool color, int square) {
-    uint64_t occupied = this->occupied & MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-    uint64_t key = (occupied * MoveGen::BISHOP_MAGICS[square]) >> MoveGen::BISHOP_ATTACK_SHIFTS[square];
-    uint64_t moves = MoveGen::BB_BISHOP_ATTACKS[square][key];
-    return moves & ~(this->wOccupied * color + this->bOccupied * !color);
+template<bool Color>
+uint64_t Bitboard::get_bishop_moves(int square) {
+    uint64_t moves = Bitboard::_get_bishop_attacks(square, this->occupied);
+    return moves & ~(this->colorBB[Color]);
 }
 
-uint64_t Bitboard::get_knight_moves(bool color, int square) {
+template<bool Color>
+uint64_t Bitboard::get_knight_moves(int square) {
     uint64_t moves = MoveGen::BB_KNIGHT_ATTACKS[square];
-    return moves & ~(this->wOccupied * color + this->bOccupied * !color);
+    return moves & ~(this->colorBB[Color]);
 }
 
-uint64_t Bitboard::get_pawn_moves(bool color, int square) {
-    if (color == WHITE) {
-        uint64_t pawn = Bitboard::BB_SQUARES[square];
-
-        uint64_t single_push = (pawn << 8) & ~this->occupied;
-        uint64_t double_push = ((single_push & Bitboard::BB_RANK_3) << 8) & ~this->occupied;
+template<bool Color>
+uint64_t Bitboard::get_pawn_moves(int square) {
+    const uint64_t pawn = Bitboard::BB_SQUARES[square];
 
-        uint64_t captures = (((pawn << 9) & ~Bitboard::BB_FILE_A) | ((pawn << 7) & ~Bitboard::BB_FILE_H))
-                            & this->bOccupied;
+    uint64_t single_push = (Color == WHITE ? pawn << 8 : pawn >> 8) & ~this->occupied;
+    uint64_t double_push = Color == WHITE ? ((single_push & Bitboard::BB_RANK_3) << 8) & ~this->occupied
+                                          : ((single_push & Bitboard::BB_RANK_6) >> 8) & ~this->occupied;
 
-        if (this->en_passant_square != INVALID && Bitboard::rankOf(square) + 1 == 5) {
-            uint64_t ep_capture = (((pawn << 9) & ~Bitboard::BB_FILE_A) | ((pawn << 7) & ~Bitboard::BB_FILE_H))
-                                  & Bitboard::BB_SQUARES[this->en_passant_square];
-            captures |= ep_capture;
-        }
-        return single_push | double_push | captures;
-    } else {
-        uint64_t pawn = Bitboard::BB_SQUARES[square];
+    uint64_t captures = pawnAttacks<Color>(pawn) & (this->colorBB[!Color]);
 
-        uint64_t single_push = (pawn >> 8) & ~(this->occupied);
-        uint64_t double_push = ((single_push & Bitboard::BB_RANK_6) >> 8) & ~(this->occupied);
-
-        uint64_t captures = (((pawn >> 9) & ~Bitboard::BB_FILE_H) | ((pawn >> 7) & ~Bitboard::BB_FILE_A))
-                            & this->wOccupied;
+    if (this->en_passant_square != INVALID && Bitboard::rankOf(square) == (Color == WHITE ? 4 : 3)) {
+        captures |= pawnAttacks<Color>(pawn) & Bitboard::BB_SQUARES[this->en_passant_square];
+    }
+    return single_push | double_push | captures;
+}
 
-        if (this->en_passant_square != INVALID && Bitboard::rankOf(square) + 1 == 4) {
-            uint64_t ep_capture = (((pawn >> 9) & ~Bitboard::BB_FILE_H) | ((pawn >> 7) & ~Bitboard::BB_FILE_A))
-                                  & Bitboard::BB_SQUARES[this->en_passant_square];
-            captures |= ep_capture;
+/**
+ * Pins are taken from the position before the exchange. A pinned piece may only join in along its pin
+ * line, as long as any piece pinning it is still on the board.
+ */
+void Bitboard::_get_exchange_pins(uint64_t target, uint64_t *pinned, uint64_t *pinners) {
+    const stateinfo_t &state = this->getStateInfo();
+    const bool side = this->turn;
+    pinned[side] = state.pinned;
+    pinners[side] = state.pinners;
+    const int enemyKing = side ? this->bKingSquare : this->wKingSquare;
+    const uint64_t enemyRookRays = Bitboard::_get_rook_attacks(enemyKing, 0);
+    const uint64_t enemyBishopRays = Bitboard::_get_bishop_attacks(enemyKing, 0);
+    const uint64_t enemySnipers = ((enemyRookRays & (this->typeBB[ROOK] | this->typeBB[QUEEN])) |
+                                   (enemyBishopRays & (this->typeBB[BISHOP] | this->typeBB[QUEEN]))) & this->colorBB[side];
+    pinned[!side] = this->_get_blockers(enemyKing, enemySnipers, this->colorBB[!side], &pinners[!side]);
+    for (int c = 0; c < 2; ++c) {
+        const int kingSquare = c == WHITE ? this->wKingSquare : this->bKingSquare;
+        uint64_t pieces = pinned[c];
+        while (pieces) {
+            int square = BitUtils::pullLSB(&pieces);
+            if (Bitboard::BB_RAYS[kingSquare][square] & target) {
+                pinned[c] &= ~Bitboard::BB_SQUARES[square];
+            }
         }
-        return single_push | double_push | captures;
-    }
-}
-
-uint64_t Bitboard::considerXrayAttacks(int from, int to) {
-    int shiftAmt;
-    uint64_t iterator = Bitboard::BB_SQUARES[from], boundary;
-    if (from > to) {
-        // Left-Shift
-        bool topLeft = Bitboard::fileOf(from) < Bitboard::fileOf(to);
-        bool top = Bitboard::fileOf(from) == Bitboard::fileOf(to);
-        bool right = Bitboard::rankOf(from) == Bitboard::rankOf(to);
-        bool topRight = (Bitboard::fileOf(from) > Bitboard::fileOf(to)) & (Bitboard::rankOf(from) > Bitboard::rankOf(to));
-        shiftAmt = 7 * topLeft + 8 * top + right + 9 * topRight;
-        boundary = ((topRight | right) * Bitboard::BB_FILE_A) + (topLeft * Bitboard::BB_FILE_H);
-        do {
-            iterator = (iterator << shiftAmt) & ~boundary;
-            if (iterator & this->occupied)
-                return iterator;
-        } while (iterator);
-    } else {
-        // Right-Shift
-        bool bottomRight = Bitboard::fileOf(from) > Bitboard::fileOf(to);
-        bool bottom = Bitboard::fileOf(from) == Bitboard::fileOf(to);
-        bool left = Bitboard::rankOf(from) == Bitboard::rankOf(to);
-        bool bottomLeft = ((Bitboard::fileOf(from) < Bitboard::fileOf(to)) & (Bitboard::rankOf(from) < Bitboard::rankOf(to)));
-        shiftAmt = left + 7 * bottomRight + 8 * bottom + 9 * bottomLeft;
-        boundary = (Bitboard::BB_FILE_A * bottomRight) + (Bitboard::BB_FILE_H * (left | bottomLeft));
-        do {
-            iterator = (iterator >> shiftAmt) & ~boundary;
-            if (iterator & this->occupied)
-                return iterator;
-        } while (iterator);
-    }
-    return 0ULL;
-}
-
-void Bitboard::clearBb(uint64_t from_bb) {
-    this->occupied &= ~from_bb;
-    this->wOccupied &= ~from_bb;
-    this->bOccupied &= ~from_bb;
-    this->wPawns &= ~from_bb;
-    this->wKnights &= ~from_bb;
-    this->wBishops &= ~from_bb;
-    this->wRooks &= ~from_bb;
-    this->wQueens &= ~from_bb;
-    this->wKing &= ~from_bb;
-    this->bPawns &= ~from_bb;
-    this->bKnights &= ~from_bb;
-    this->bBishops &= ~from_bb;
-    this->bRooks &= ~from_bb;
-    this->bQueens &= ~from_bb;
-    this->bKing &= ~from_bb;
+    }
 }
 
 int32_t Bitboard::fastSEE(move_t move) {
-    const Bitboard copy = *this;
     int gain[32], d = 0;
-    uint64_t maxXray = this->wPawns | this->bPawns | this->wBishops | this->bBishops | this->wRooks | this->bRooks | this->wQueens | this->bQueens;
+    const uint64_t bbTo = Bitboard::BB_SQUARES[move.to];
+    const uint64_t bq_bb = this->typeBB[BISHOP] | this->typeBB[QUEEN];
+    const uint64_t rq_bb = this->typeBB[ROOK] | this->typeBB[QUEEN];
+    const uint64_t kings = this->typeBB[KING];
+
+    /** The mover is off its square from the start, so that sliders behind it on the same line join in */
     uint64_t fromBb = Bitboard::BB_SQUARES[move.from];
-    uint64_t attadef = this->attacksTo(move.to);
+    uint64_t occupied = this->occupied & ~fromBb;
+    if (move.flag == EN_PASSANT) {
+        occupied ^= Bitboard::BB_SQUARES[this->turn ? move.to - 8 : move.to + 8];
+    }
+    uint64_t attadef = this->attackersTo(move.to, occupied);
     gain[d] = (this->pieceValue(move.to) * (this->mailbox[move.to] != piece_t::EMPTY)) + Weights::MATERIAL[piece_t::BLACK_PAWN] * (move.flag == EN_PASSANT);
     
     piece_t attackingPiece = this->mailbox[move.from];
-    uint64_t bbTo = Bitboard::BB_SQUARES[move.to];
+    bool side = this->turn;
+
+    uint64_t pinned[2], pinners[2];
+    this->_get_exchange_pins(bbTo, pinned, pinners);
+
     do {
         ++d;
-        gain[d] = pieceValue(attackingPiece) - gain[d - 1];
+        gain[d] = SearchContext::pieceValue(attackingPiece) - gain[d - 1];
         if (std::max(-gain[d - 1], gain[d]) < 0) break;
-        attadef ^= fromBb;
-        this->clearBb(fromBb);
-        if (fromBb & maxXray) {
-            attadef |= considerXrayAttacks(BitUtils::getLSB(fromBb), move.to);
-        }
+        occupied &= ~fromBb;
 
-        // Add king attacks to the static exchange evaluation
-        int king = (!this->turn * BitUtils::getLSB(this->wKing)) + (this->turn * BitUtils::getLSB(this->bKing));
-        if (king != -1 && (bbTo & MoveGen::BB_KING_ATTACKS[king])) {
-            uint64_t attackmask = this->_get_attackmask(this->turn);
-            bool king_can_reach = (MoveGen::BB_KING_ATTACKS[king] & bbTo) != 0;
-            bool square_undefended = (bbTo & attackmask) == 0;
-            attadef |= Bitboard::BB_SQUARES[king] * (king_can_reach & square_undefended);
+        /** Taking the piece off may uncover a slider behind it on the same line */
+        piece_t type = static_cast<piece_t> (attackingPiece % 6);
+        if (type == piece_t::BLACK_PAWN || type == piece_t::BLACK_BISHOP || type == piece_t::BLACK_QUEEN) {
+            attadef |= Bitboard::_get_bishop_attacks(move.to, occupied) & bq_bb;
+        }
+        if (type == piece_t::BLACK_ROOK || type == piece_t::BLACK_QUEEN) {
+            attadef |= Bitboard::_get_rook_attacks(move.to, occupied) & rq_bb;
         }
+        attadef &= occupied;
 
-        this->turn = !this->turn;
-        fromBb = findLVA(attadef, attackingPiece, Bitboard::BB_SQUARES[move.to]);
+        side = !side;
+        uint64_t attackers = attadef & (this->colorBB[side]);
+        if (pinners[side] & occupied) {
+            attackers &= ~pinned[side];
+        }
+        /** The king captures last, and only if the other side has nothing left to take it back with */
+        if (attackers & ~kings) {
+            attackers &= ~kings;
+        } else if (attadef & (this->colorBB[!side])) {
+            attackers = 0;
+        }
+        fromBb = findLVA(attackers, attackingPiece);
     } while (fromBb);
     while (--d) {
         gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
     }
-    *this = copy;
     return gain[0];
 }
 
-/**
- *
- */
-uint64_t Bitboard::attacksTo(int targetSquare) {
-    uint64_t attacks = 0ULL;
-    uint64_t pieces = this->occupied;
+bool Bitboard::see_ge(const move_t &move, int32_t threshold) {
+    if (move.flag == MoveFlags::CASTLING) {
+        return threshold <= 0;
+    }
+    const int from = move.from;
+    const int to = move.to;
+    const uint64_t bbTo = Bitboard::BB_SQUARES[to];
+
+    /** swap is what the side that just captured stands to lose if the last capturer is taken */
+    int32_t swap = (move.flag == MoveFlags::EN_PASSANT ? Weights::MATERIAL[piece_t::BLACK_PAWN] : this->pieceValue(to)) - threshold;
+    if (swap < 0) return false;
+    swap = SearchContext::pieceValue(this->mailbox[from]) - swap;
+    if (swap <= 0) return true;
+
+    uint64_t occupied = this->occupied ^ Bitboard::BB_SQUARES[from];
+    if (move.flag == MoveFlags::EN_PASSANT) {
+        occupied ^= Bitboard::BB_SQUARES[this->turn ? to - 8 : to + 8];
+    }
+    const uint64_t bq_bb = this->typeBB[BISHOP] | this->typeBB[QUEEN];
+    const uint64_t rq_bb = this->typeBB[ROOK] | this->typeBB[QUEEN];
+    uint64_t attackers = this->attackersTo(to, occupied);
+
+    uint64_t pinned[2], pinners[2];
+    this->_get_exchange_pins(bbTo, pinned, pinners);
+
+    bool side = this->turn;
+    bool result = true;
+    while (true) {
+        side = !side;
+        attackers &= occupied;
+        uint64_t sideAttackers = attackers & (this->colorBB[side]);
+        if (pinners[side] & occupied) {
+            sideAttackers &= ~pinned[side];
+        }
+        if (!sideAttackers) break;
+        result = !result;
+
+        /** Least valuable attacker first, piece_t lists the piece types from least to most valuable */
+        int type;
+        uint64_t bb = 0;
+        for (type = piece_t::BLACK_PAWN; type < piece_t::BLACK_KING; ++type) {
+            if ((bb = sideAttackers & this->typeBB[type])) break;
+        }
+        if (type == piece_t::BLACK_KING) {
+            /** The king can't capture onto a square the other side still attacks */
+            return (attackers & (this->colorBB[!side])) ? !result : result;
+        }
 
-    const uint64_t targetBb = Bitboard::BB_SQUARES[targetSquare];
-    const uint64_t attackmasks[2] = { this->_get_attackmask(BLACK), this->_get_attackmask(WHITE)};
-    while (pieces) {
-        int i = BitUtils::pullLSB(&pieces);
-        int oppositeColor = (this->mailbox[i] < 6);
-        piece_t pieceType = static_cast<piece_t> ((static_cast<int> (this->mailbox[i]) % 6));
-        switch (pieceType) {
-            case BLACK_PAWN: {
-                int pawnFile = Bitboard::fileOf(i), pawn_rank = Bitboard::rankOf(i);
-                int targetFile = Bitboard::fileOf(targetSquare), target_rank = Bitboard::rankOf(targetSquare);
-                bool areFilesAdjacent = abs(pawnFile - targetFile) == 1;
-                bool isDirectionCorrect = (target_rank - pawn_rank) == (1 - (2 * (this->mailbox[i] < 6)));
-                uint64_t result = areFilesAdjacent & isDirectionCorrect;
-                attacks |= (result << i);
-                break;
-            }
-            case BLACK_KNIGHT: {
-                bool isAttacking = (MoveGen::BB_KNIGHT_ATTACKS[i] & targetBb) != 0;
-                attacks |= (uint64_t(isAttacking) << i);
-                break;
-            }
-            case BLACK_BISHOP: {
-                uint64_t bishopAttacks = (Bitboard::BB_DIAGONALS[Bitboard::diagonalOf(i)] ^
-                                           Bitboard::BB_ANTI_DIAGONALS[Bitboard::antiDiagonalOf(i)]);
-                uint64_t ray = Bitboard::getRayBetween(i, targetSquare) & ~Bitboard::BB_SQUARES[i] & ~Bitboard::BB_SQUARES[targetSquare];
-                bool alignmentExists = (bishopAttacks | targetBb) == bishopAttacks;
-                bool obstructionFree = (ray ^ this->occupied) == (ray | this->occupied);
-                uint64_t result = alignmentExists & obstructionFree;
-                attacks |= (result << i);
-                break;
-            }
-            case BLACK_ROOK: {
-                uint64_t rook_attacks = (Bitboard::BB_RANKS[Bitboard::rankOf(i)] ^ Bitboard::BB_FILES[Bitboard::fileOf(i)]);
-                uint64_t ray = Bitboard::getRayBetween(i, targetSquare) & ~Bitboard::BB_SQUARES[i] & ~Bitboard::BB_SQUARES[targetSquare];
-                bool alignmentExists = ((rook_attacks | targetBb) == rook_attacks);
-                bool obstructionFree = (ray ^ this->occupied) == (ray | this->occupied);
-                uint64_t result = alignmentExists & obstructionFree;
-                attacks |= (result << i);
-                break;
-            }
-            case BLACK_QUEEN: {
-                uint64_t ray = Bitboard::getRayBetween(targetSquare, i);
-                bool alignmentExists = ray != 0;
-                ray &= ~Bitboard::BB_SQUARES[i];
-                ray &= ~Bitboard::BB_SQUARES[targetSquare];
-                bool obstructionFree = (ray ^ this->occupied) == (ray | this->occupied);
-                uint64_t result = alignmentExists & obstructionFree;
-                attacks |= (result << i);
-                break;
-            }
-            case BLACK_KING: {
-                bool canKingReach = (MoveGen::BB_KING_ATTACKS[i] & targetBb & ~attackmasks[oppositeColor]) != 0;
-                uint64_t result = canKingReach;
-                attacks |= (result << i);
-                break;
-            }
-            default:
-                std::cout << "Something is seriously wrong in attacks_to() in bitboard.cpp\n";
-                exit(0);
+        swap = Weights::MATERIAL[type] - swap;
+        if (swap < result) break;
+
+        occupied ^= bb & -bb;
+        if (type == piece_t::BLACK_PAWN || type == piece_t::BLACK_BISHOP || type == piece_t::BLACK_QUEEN) {
+            attackers |= Bitboard::_get_bishop_attacks(to, occupied) & bq_bb;
+        }
+        if (type == piece_t::BLACK_ROOK || type == piece_t::BLACK_QUEEN) {
+            attackers |= Bitboard::_get_rook_attacks(to, occupied) & rq_bb;
         }
     }
-    return attacks;
+    return result;
 }
 
+uint64_t Bitboard::attackersTo(int square, uint64_t occupied) {
+    const uint64_t square_bb = Bitboard::BB_SQUARES[square];
+    return (MoveGen::get_pawn_attacks_setwise(square_bb, BLACK) & this->pieces(WHITE, PAWN)) |
+           (MoveGen::get_pawn_attacks_setwise(square_bb, WHITE) & this->pieces(BLACK, PAWN)) |
+           (MoveGen::BB_KNIGHT_ATTACKS[square] & this->typeBB[KNIGHT]) |
+           (MoveGen::BB_KING_ATTACKS[square] & this->typeBB[KING]) |
+           (Bitboard::_get_bishop_attacks(square, occupied) & (this->typeBB[BISHOP] | this->typeBB[QUEEN])) |
+           (Bitboard::_get_rook_attacks(square, occupied) & (this->typeBB[ROOK] | this->typeBB[QUEEN]));
+}
 
-/**
- * @param piece
- * @return a pointer to the bitboard of the piece.
- */
-uint64_t *Bitboard::getBitboard(const piece_t &piece) {
-    switch (piece) {
-        case WHITE_PAWN:
-            return &this->wPawns;
-        case WHITE_KNIGHT:
-            return &this->wKnights;
-        case WHITE_BISHOP:
-            return &this->wBishops;
-        case WHITE_ROOK:
-            return &this->wRooks;
-        case WHITE_QUEEN:
-            return &this->wQueens;
-        case WHITE_KING:
-            return &this->wKing;
-        case BLACK_PAWN:
-            return &this->bPawns;
-        case BLACK_KNIGHT:
-            return &this->bKnights;
-        case BLACK_BISHOP:
-            return &this->bBishops;
-        case BLACK_ROOK:
-            return &this->bRooks;
-        case BLACK_QUEEN:
-            return &this->bQueens;
-        case BLACK_KING:
-            return &this->bKing;
-        default:
-            return nullptr;
+void Bitboard::_put_piece(piece_t piece, int square) {
+    const uint64_t bb = Bitboard::BB_SQUARES[square];
+    this->typeBB[piece % 6] |= bb;
+    this->colorBB[piece >= piece_t::WHITE_PAWN] |= bb;
+    this->occupied |= bb;
+    this->mailbox[square] = piece;
+    this->midgameScore += Bitboard::PSQT_VALUES.midgame[piece][square];
+    this->endgameScore += Bitboard::PSQT_VALUES.endgame[piece][square];
+    this->phase += Bitboard::PSQT_VALUES.phase[piece];
+    this->material_key += 1ULL << (4 * piece);
+    if (piece % 6 == PAWN) {
+        this->pawn_hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) piece + square];
+    }
+}
+
+void Bitboard::_remove_piece(int square) {
+    const piece_t piece = this->mailbox[square];
+    const uint64_t bb = Bitboard::BB_SQUARES[square];
+    this->typeBB[piece % 6] ^= bb;
+    this->colorBB[piece >= piece_t::WHITE_PAWN] ^= bb;
+    this->occupied ^= bb;
+    this->mailbox[square] = piece_t::EMPTY;
+    this->midgameScore -= Bitboard::PSQT_VALUES.midgame[piece][square];
+    this->endgameScore -= Bitboard::PSQT_VALUES.endgame[piece][square];
+    this->phase -= Bitboard::PSQT_VALUES.phase[piece];
+    this->material_key -= 1ULL << (4 * piece);
+    if (piece % 6 == PAWN) {
+        this->pawn_hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) piece + square];
+    }
+}
+
+void Bitboard::_move_piece(int from, int to) {
+    const piece_t piece = this->mailbox[from];
+    const uint64_t bb = Bitboard::BB_SQUARES[from] | Bitboard::BB_SQUARES[to];
+    this->typeBB[piece % 6] ^= bb;
+    this->colorBB[piece >= piece_t::WHITE_PAWN] ^= bb;
+    this->occupied ^= bb;
+    this->mailbox[from] = piece_t::EMPTY;
+    this->mailbox[to] = piece;
+    this->midgameScore += Bitboard::PSQT_VALUES.midgame[piece][to] - Bitboard::PSQT_VALUES.midgame[piece][from];
+    this->endgameScore += Bitboard::PSQT_VALUES.endgame[piece][to] - Bitboard::PSQT_VALUES.endgame[piece][from];
+    if (piece % 6 == PAWN) {
+        this->pawn_hash_code ^= Bitboard::ZOBRIST_VALUES[64 * (int) piece + from] ^ Bitboard::ZOBRIST_VALUES[64 * (int) piece + to];
     }
 }
 
@@ -1462,18 +1550,8 @@ void Bitboard::printBoard() {
 
 bool Bitboard::operator==(const Bitboard &other) {
     return
-        (this->wPawns == other.wPawns) && 
-        (this->wKnights == other.wKnights) &&
-        (this->wBishops == other.wBishops) &&
-        (this->wRooks == other.wRooks) &&
-        (this->wQueens == other.wQueens) &&
-        (this->wKing == other.wKing) &&
-        (this->bPawns = other.bPawns) &&
-        (this->bKnights = other.bKnights) &&
-        (this->bBishops == other.bBishops) &&
-        (this->bRooks == other.bRooks) &&
-        (this->bQueens == other.bQueens) &&
-        (this->bKing == other.bKing) &&
+        !std::memcmp(this->typeBB, other.typeBB, sizeof(this->typeBB)) &&
+        !std::memcmp(this->colorBB, other.colorBB, sizeof(this->colorBB)) &&
         (this->turn == other.turn) &&
         (this->wKingsideCastleRights == other.wKingsideCastleRights) &&
         (this->wQueensideCastleRights == other.wQueensideCastleRights) &&
@@ -1482,24 +1560,14 @@ bool Bitboard::operator==(const Bitboard &other) {
 }
 
 void Bitboard::operator=(const Bitboard &other) {
-    std::memcpy(this->mailbox, &(other.mailbox), 64 * sizeof(piece_t));
-    this->wPawns = other.wPawns;
-    this->wKnights = other.wKnights;
-    this->wBishops = other.wBishops;
-    this->wRooks = other.wRooks;
-    this->wQueens = other.wQueens;
-    this->wKing = other.wKing;
-
-    this->bPawns = other.bPawns;
-    this->bKnights = other.bKnights;
-    this->bBishops = other.bBishops;
-    this->bRooks = other.bRooks;
-    this->bQueens = other.bQueens;
-    this->bKing = other.bKing;
-
+    std::memcpy(this->mailbox, other.mailbox, sizeof(this->mailbox));
+    std::memcpy(this->typeBB, other.typeBB, sizeof(this->typeBB));
+    std::memcpy(this->colorBB, other.colorBB, sizeof(this->colorBB));
     this->occupied = other.occupied;
-    this->wOccupied = other.wOccupied;
-    this->bOccupied = other.bOccupied;
+
+    this->midgameScore = other.midgameScore;
+    this->endgameScore = other.endgameScore;
+    this->phase = other.phase;
 
     this->wKingSquare = other.wKingSquare;
     this->bKingSquare = other.bKingSquare;
@@ -1516,4 +1584,9 @@ void Bitboard::operator=(const Bitboard &other) {
     this->halfmove_clock = other.halfmove_clock;
     this->fullmove_number = other.fullmove_number;
     this->hash_code = other.hash_code;
+    this->pawn_hash_code = other.pawn_hash_code;
+    this->material_key = other.material_key;
+
+    this->state = other.state;
+    this->stateValid = other.stateValid;
 }
\ No newline at end of file
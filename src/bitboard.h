@@ -4,30 +4,107 @@
 
 #include "util.h"
 
+/**
+ * Table of 64x64 lines indexed like a two dimensional array, so it can be built by a constexpr function.
+ */
+struct ray_table_t {
+    uint64_t rays[64][64];
+
+    constexpr const uint64_t *operator[](int square) const {
+        return rays[square];
+    }
+};
+
+/**
+ * Table of Zobrist keys, wrapped so it can be built by a constexpr function.
+ */
+struct zobrist_table_t {
+    uint64_t keys[781];
+
+    constexpr uint64_t operator[](int i) const {
+        return keys[i];
+    }
+};
+
+/**
+ * Material plus piece-square value of each piece_t on each square from white's point of view, for the
+ * midgame and the endgame, and the game phase weight of each piece_t. Wrapped so it can be built by a
+ * constexpr function.
+ */
+struct psqt_table_t {
+    int32_t midgame[12][64];
+    int32_t endgame[12][64];
+    uint16_t phase[12];
+};
+
+/**
+ * Check and pin data of the side to move, shared by move generation, move validation and SEE.
+ * Computed at most once per position by Bitboard::getStateInfo.
+ */
+struct stateinfo_t {
+    uint64_t checkers; // Enemy pieces giving check
+    uint64_t checkmask; // Squares that capture or block the checker, all squares if not in check, none in double check
+    uint64_t pinned; // Pieces of the side to move pinned to their king
+    uint64_t pinners; // Enemy sliders pinning them
+    uint64_t attackmask; // Squares attacked by the enemy, with sliders seeing through the king
+};
+
+/**
+ * The state makeMove can't recompute when a move is taken back. Returned by
+ * makeMove and consumed by unmakeMove, so that the search never copies boards.
+ */
+struct undo_t {
+    move_t move;
+    piece_t captured; // EMPTY for quiet moves and en passant
+
+    bool wKingsideCastleRights;
+    bool wQueensideCastleRights;
+    bool bKingsideCastleRights;
+    bool bQueensideCastleRights;
+
+    int en_passant_square;
+    int halfmove_clock;
+    uint64_t hash_code;
+
+    stateinfo_t state;
+    bool stateValid;
+};
+
+/**
+ * Per-position data that reduces "does this move give check" to a few bitboard tests.
+ * Computed once per node by Bitboard::getCheckInfo.
+ */
+struct checkinfo_t {
+    // Squares from which a piece of the side to move, indexed by piece_t % 6, attacks the enemy king
+    uint64_t checkSquares[6];
+
+    // Pieces of the side to move that alone block one of its sliders from the enemy king
+    uint64_t discoverers;
+
+    int kingSquare;
+};
+
 struct Bitboard {
 
     friend struct Evaluation;
     friend struct UCI;
 
+    // Piece types, in the order of piece_t, so the type of a piece is piece_t % 6
+    enum piece_type_t {
+        PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING
+    };
+
 private:
-    piece_t mailbox[64]; // piece-centric board representation
-
-    uint64_t wPawns;
-    uint64_t wKnights;
-    uint64_t wBishops;
-    uint64_t wRooks;
-    uint64_t wQueens;
-    uint64_t wKing;
-    uint64_t bPawns;
-    uint64_t bKnights;
-    uint64_t bBishops;
-    uint64_t bRooks;
-    uint64_t bQueens;
-    uint64_t bKing;
+    piece_t mailbox[64]; // piece-centric board representation, one byte per square
 
+    uint64_t typeBB[6]; // pieces of both colors, indexed by piece_type_t
+    uint64_t colorBB[2]; // pieces of either color, indexed by WHITE and BLACK
     uint64_t occupied;
-    uint64_t wOccupied;
-    uint64_t bOccupied;
+
+    // material and piece-square sums from white's point of view, and the game phase, kept up to date as pieces move
+    int32_t midgameScore;
+    int32_t endgameScore;
+    uint16_t phase;
 
     int wKingSquare;
     int bKingSquare;
@@ -49,31 +126,88 @@ private:
 
     // hash code for the current position
     uint64_t hash_code;
+    // hash code of the pawns alone, made of the same Zobrist keys
+    uint64_t pawn_hash_code;
+    // number of pieces of each piece_t, four bits apiece from bit 4 * piece_t. Unique to the material, unlike a hash
+    uint64_t material_key;
 
-    // Internal helper functions for movegen
+    // check and pin data of the side to move, only meaningful while stateValid is set
+    stateinfo_t state;
+    bool stateValid;
+
+    // Internal helper functions for movegen, specialized at compile time for the side they generate for.
+    // Legal selects strictly legal generation, else pins and en passant are left to isLegal.
 
     /**
-     * @param color
-     * @return the bitboard of squares the king of the color can't go.
+     * Update the mailbox, every bitboard the piece is in, the PSQT sums, the pawn hash code and the material
+     * key. The hash code is left to the caller.
+     */
+    void _put_piece(piece_t piece, int square);
+
+    void _remove_piece(int square);
+
+    void _move_piece(int from, int to);
+
+    template<bool Color, bool Legal>
+    int _gen_moves(move_t *moves);
+
+    template<bool Color, bool Legal>
+    int _gen_captures(move_t *moves);
+
+    template<bool Color, bool Legal>
+    int _gen_nonquiescent_moves(move_t *moves);
+
+    /**
+     * Generates the pawn moves setwise. Each kind of pawn move is found for all pawns at once
+     * by shifting the pawn bitboard, and pinned pawns are masked out of the directions their pin
+     * does not run along.
+     * @tparam Quiets whether to include pushes and quiet promotions, else only captures.
+     * @param state the state info of the side to generate for.
+     */
+    template<bool Color, bool Quiets, bool Legal>
+    int _gen_pawn_moves(move_t *moves, const stateinfo_t &state);
+
+    /**
+     * @param from the square of the pawn capturing en passant.
+     * @return whether the capture leaves the king of the color safe.
+     */
+    template<bool Color>
+    bool _is_en_passant_legal(int from);
+
+    template<bool Color>
+    bool _is_move_legal(const move_t &move);
+
+    /**
+     * @return the bitboard of squares the king of the other color can't go.
      * All squares the color is attacking.
      */
-    uint64_t _get_attackmask(bool color);
+    template<bool Color>
+    uint64_t _get_attackmask();
 
     /**
-     * @param color the color of the king possibly in check.
-     * @return all squares if the king is not in check, else
-     * the path between the attacking piece and the color's king.
-     * Returns empty bitboard if in double or more check.
+     * @param square the square sliders are aimed at.
+     * @param snipers the sliders aimed at the square on an empty board.
+     * @param pieces the pieces that count as blockers.
+     * @param pinners set to the snipers blocked by exactly one of the pieces.
+     * @return the pieces that alone block a sniper from the square.
      */
-    uint64_t _get_checkmask(bool color);
+    uint64_t _get_blockers(int square, uint64_t snipers, uint64_t pieces, uint64_t *pinners);
 
     /**
-     * @param color
-     * @param king_square
-     * @param square the square the possibly pinned piece is on.
-     * @return a possible pin ray for the piece.
+     * @return the check and pin data of the king of the color.
      */
-    uint64_t _get_pinmask(bool color, int square);
+    template<bool Color>
+    stateinfo_t _get_state();
+
+    /**
+     * @return the check and pin data of the king of the color, cached if the color is to move.
+     */
+    template<bool Color>
+    stateinfo_t _get_state_of();
+
+    static uint64_t _get_rook_attacks(int square, uint64_t occupied);
+
+    static uint64_t _get_bishop_attacks(int square, uint64_t occupied);
 
     /**
      * @param color the side to move
@@ -84,57 +218,71 @@ private:
      */
     MoveFlags getFlag(piece_t piece, int from, int to);
 
+    template<bool Color>
+    bool canCastle(int from, int to, uint64_t attackmask);
+
     /**
-     * @param color the color of the king
+     * @tparam Color the color of the king
      * @param square the square the king is on
      * @return where the king can move from the given square
      */
-    uint64_t get_king_moves(bool color, int square);
+    template<bool Color>
+    uint64_t get_king_moves(int square);
 
-    uint64_t get_king_moves_no_castle(bool color, int square);
+    template<bool Color>
+    uint64_t get_king_moves_no_castle(int square);
 
     /**
-     * @param color the color of the queen
+     * @tparam Color the color of the queen
      * @param square the square the queen is on
      * @return where the queen can move from the given square
      */
-    uint64_t get_queen_moves(bool color, int square);
+    template<bool Color>
+    uint64_t get_queen_moves(int square);
 
     /**
-     * @param color the color of the rook
+     * @tparam Color the color of the rook
      * @param square the square the rook is on
      * @return where the rook can move from the given square
      */
-    uint64_t get_rook_moves(bool color, int square);
+    template<bool Color>
+    uint64_t get_rook_moves(int square);
 
     /**
-     * @param color the color of the bishop
+     * @tparam Color the color of the bishop
      * @param square the square the bishop is on
      * @return where the bishop can move from the given square
      */
-    uint64_t get_bishop_moves(bool color, int square);
+    template<bool Color>
+    uint64_t get_bishop_moves(int square);
 
     /**
-     * @param color the color of the knight
+     * @tparam Color the color of the knight
      * @param square the square the knight is on
      * @return where the knight can move from the given square
      */
-    uint64_t get_knight_moves(bool color, int square);
+    template<bool Color>
+    uint64_t get_knight_moves(int square);
 
     /**
-     * @param color the color of the pawn.
+     * @tparam Color the color of the pawn.
      * @param square the square the pawn is on.
      * @return where the pawn can move from the given square.
      */
-    uint64_t get_pawn_moves(bool color, int square);
-
-    // Internal helper functions for fastSEE
+    template<bool Color>
+    uint64_t get_pawn_moves(int square);
 
-    uint64_t findLVA(uint64_t, piece_t &, uint64_t);
+    // Internal helper functions for fastSEE and see_ge
 
-    uint64_t considerXrayAttacks(int, int);
+    uint64_t findLVA(uint64_t, piece_t &);
 
-    void clearBb(uint64_t);
+    /**
+     * Pins of both sides that keep a piece out of an exchange, indexed by color.
+     * @param target the square the exchange is on.
+     * @param pinned set to the pinned pieces that can't reach the target along their pin line.
+     * @param pinners set to the sliders pinning them.
+     */
+    void _get_exchange_pins(uint64_t target, uint64_t *pinned, uint64_t *pinners);
 
 public:
 
@@ -144,6 +292,8 @@ public:
 
     static const uint64_t BB_ALL;
 
+    static const uint64_t BB_LIGHT_SQUARES;
+
     static const uint64_t BB_FILE_A;
     static const uint64_t BB_FILE_B;
     static const uint64_t BB_FILE_C;
@@ -203,11 +353,20 @@ public:
     static const uint64_t BB_ANTI_DIAGONALS[15];
 
 
-    static uint64_t BB_RAYS[64][64];
+    // Full line through two squares, or 0 if they are not aligned. Built at compile time
+    static const ray_table_t BB_RAYS;
+
+    /**
+     * Zobrist keys: 12 pieces on 64 squares, white to move, the four castling rights and the eight en
+     * passant files. Generated at compile time from a fixed seed, so a position hashes to the same
+     * code in every run of every build.
+     */
+    static const zobrist_table_t ZOBRIST_VALUES;
 
-    static uint64_t ZOBRIST_VALUES[781];
+    // Built at compile time from the evaluation weights, see psqt_table_t
+    static const psqt_table_t PSQT_VALUES;
 
-    static const int MAX_MOVE_NUM;
+    static const int MAX_MOVE_NUM = 218;
     static const int MAX_CAPTURE_NUM;
     static const int MAX_ATTACK_NUM;
 
@@ -225,16 +384,15 @@ public:
 
     static uint64_t getRayBetweenInclusive(int, int);
 
-    // Initialize Structures
-
-    static void initializeZobrist();
-
     // Bitboard instance methods
 
     Bitboard(const std::string &);
 
     Bitboard();
 
+    // Copies every member, as operator= does
+    Bitboard(const Bitboard &) = default;
+
     /**
      * Takes in an empty array and generates the list of legal moves in it.
      * @param moves the array to store the moves in.
@@ -253,7 +411,33 @@ public:
 
     int genNonquiescentMoves(move_t *moves, bool color);
 
-    void makeMove(const move_t &);
+    /**
+     * Generates the moves of the side to move without checking pins or whether en passant exposes
+     * the king, so that a search which cuts off early never pays for it. Every move must pass
+     * isLegal before it is made.
+     * @param moves the array to store the moves in.
+     * @param return the number of moves.
+     */
+    int genPseudoLegalMoves(move_t *moves);
+
+    /**
+     * The pseudo-legal counterpart of genNonquiescentMoves, for the side to move.
+     */
+    int genPseudoLegalNonquiescentMoves(move_t *moves);
+
+    /**
+     * Updates the board with the move.
+     * @param move the move to make.
+     * @return the undo record to take the move back with.
+     */
+    undo_t makeMove(const move_t &move);
+
+    /**
+     * Restores the position from before the move of the undo record. Moves must be taken back
+     * in the reverse order they were made.
+     * @param undo the record returned by makeMove.
+     */
+    void unmakeMove(const undo_t &undo);
 
     move_t parseMove(const std::string &);
 
@@ -261,6 +445,29 @@ public:
 
     bool isMoveCheck(const move_t &);
 
+    /**
+     * @return the check and pin data of the side to move, computed on the first call in a position.
+     */
+    const stateinfo_t &getStateInfo();
+
+    checkinfo_t getCheckInfo();
+
+    /**
+     * @param move a legal move of the side to move.
+     * @param ci the check info of this position.
+     * @return whether the move gives check.
+     */
+    bool givesCheck(const move_t &move, const checkinfo_t &ci);
+
+    bool isMoveLegal(const move_t &);
+
+    /**
+     * Cheap legality test from the cached pin data of the position.
+     * @param move a pseudo-legal move of the side to move.
+     * @return whether the move leaves the king safe.
+     */
+    bool isLegal(const move_t &move);
+
     bool isAttacked(bool, int);
 
     bool containsPromotions();
@@ -269,9 +476,35 @@ public:
 
     int32_t fastSEE(move_t);
 
-    uint64_t attacksTo(int);
+    /**
+     * Static exchange evaluation that only answers whether the exchange reaches the threshold. Works on
+     * an occupancy bitboard alone and stops as soon as the answer is known.
+     * @param move the capture or quiet move to evaluate.
+     * @param threshold the material balance in centi-pawns the move must at least reach.
+     * @return whether the exchange started by the move wins at least the threshold.
+     */
+    bool see_ge(const move_t &move, int32_t threshold);
+
+    /**
+     * @param square the square being attacked.
+     * @param occupied the pieces that block sliders, so that x-ray attackers appear as pieces are taken off.
+     * @return the pieces of both colors attacking the square. Pieces not in occupied may be included.
+     */
+    uint64_t attackersTo(int square, uint64_t occupied);
 
-    uint64_t *getBitboard(const piece_t &);
+    /**
+     * @return the pieces of the color and type.
+     */
+    uint64_t pieces(bool color, piece_type_t type) const {
+        return this->typeBB[type] & this->colorBB[color];
+    }
+
+    /**
+     * @return the bitboard of the piece.
+     */
+    uint64_t getBitboard(piece_t piece) const {
+        return this->pieces(piece >= piece_t::WHITE_PAWN, static_cast<piece_type_t> (piece % 6));
+    }
 
     void printBoard();
 
@@ -285,7 +518,7 @@ public:
 
     // overloaded operators
 
-    bool operator==(const Bitboard &); // TODO: Implement
+    bool operator==(const Bitboard &);
 
     void operator=(const Bitboard &);
 };
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include "endgame.h"
+#include "movegen.h"
+#include "weights.h"
+
+uint64_t Endgame::KPK_BITBASE[Endgame::KPK_SIZE / 64];
+
+// Guards the first KPK probe, which may come from several search threads at once
+static std::once_flag kpk_built;
+
+/**
+ * Results of the KPK retrograde analysis, as bit flags so that the results of all the moves of a position
+ * can be OR-ed together. Illegal positions are KPK_INVALID, and add nothing to the results of their predecessors.
+ */
+enum kpk_result_t : uint8_t {
+    KPK_INVALID = 0, KPK_UNKNOWN = 1, KPK_DRAW = 2, KPK_WIN = 4
+};
+
+int Endgame::kpkIndex(bool white_to_move, int b_king, int w_king, int pawn) {
+    return w_king | (b_king << 6) | (white_to_move << 12) | (Bitboard::fileOf(pawn) << 13) |
+           ((6 - Bitboard::rankOf(pawn)) << 15);
+}
+
+int Endgame::distance(int from, int to) {
+    return std::max(std::abs(Bitboard::fileOf(from) - Bitboard::fileOf(to)),
+                    std::abs(Bitboard::rankOf(from) - Bitboard::rankOf(to)));
+}
+
+int32_t Endgame::pushToEdge(int square) {
+    const int file = Bitboard::fileOf(square), rank = Bitboard::rankOf(square);
+    return 20 * (std::max(3 - file, file - 4) + std::max(3 - rank, rank - 4));
+}
+
+int32_t Endgame::pushClose(int from, int to) {
+    return 20 * (7 - Endgame::distance(from, to));
+}
+
+/**
+ * @return the result of the position known without looking at its moves, else KPK_UNKNOWN.
+ */
+static kpk_result_t kpkInitial(bool white_to_move, int b_king, int w_king, int pawn) {
+    const uint64_t pawn_attacks = MoveGen::get_pawn_attacks_setwise(Bitboard::BB_SQUARES[pawn], WHITE);
+    const int promotion = pawn + 8;
+
+    if (w_king == b_king || (MoveGen::BB_KING_ATTACKS[w_king] & Bitboard::BB_SQUARES[b_king]) || w_king == pawn ||
+        b_king == pawn || (white_to_move && (pawn_attacks & Bitboard::BB_SQUARES[b_king]))) {
+        return KPK_INVALID;
+    }
+    if (white_to_move) {
+        /** The pawn promotes and the queen survives */
+        if (Bitboard::rankOf(pawn) == 6 && w_king != promotion && b_king != promotion &&
+            (!(MoveGen::BB_KING_ATTACKS[b_king] & Bitboard::BB_SQUARES[promotion]) ||
+             (MoveGen::BB_KING_ATTACKS[w_king] & Bitboard::BB_SQUARES[promotion]))) {
+            return KPK_WIN;
+        }
+        return KPK_UNKNOWN;
+    }
+    /** Stalemate, or the pawn falls */
+    const uint64_t escapes = MoveGen::BB_KING_ATTACKS[b_king] & ~(MoveGen::BB_KING_ATTACKS[w_king] | pawn_attacks);
+    if (!escapes || (escapes & Bitboard::BB_SQUARES[pawn])) {
+        return KPK_DRAW;
+    }
+    return KPK_UNKNOWN;
+}
+
+void Endgame::buildKPK() {
+    std::vector<uint8_t> results(Endgame::KPK_SIZE);
+    for (int i = 0; i < Endgame::KPK_SIZE; ++i) {
+        const int pawn = 8 * (6 - (i >> 15)) + ((i >> 13) & 0x3);
+        results[i] = kpkInitial((i >> 12) & 1, (i >> 6) & 0x3f, i & 0x3f, pawn);
+    }
+
+    /**
+     * White wins if any of its moves wins, black draws if any of its moves draws. Sweep until no position
+     * changes, the positions left KPK_UNKNOWN are draws.
+     */
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < Endgame::KPK_SIZE; ++i) {
+            if (results[i] != KPK_UNKNOWN) continue;
+
+            const bool white_to_move = (i >> 12) & 1;
+            const int w_king = i & 0x3f, b_king = (i >> 6) & 0x3f;
+            const int pawn = 8 * (6 - (i >> 15)) + ((i >> 13) & 0x3);
+
+            uint8_t r = KPK_INVALID;
+            if (white_to_move) {
+                uint64_t moves = MoveGen::BB_KING_ATTACKS[w_king];
+                while (moves) {
+                    r |= results[Endgame::kpkIndex(false, b_king, BitUtils::pullLSB(&moves), pawn)];
+                }
+                /** A push blocked by a king indexes an illegal position */
+                if (Bitboard::rankOf(pawn) < 6) {
+                    r |= results[Endgame::kpkIndex(false, b_king, w_king, pawn + 8)];
+                }
+                if (Bitboard::rankOf(pawn) == 1 && w_king != pawn + 8 && b_king != pawn + 8) {
+                    r |= results[Endgame::kpkIndex(false, b_king, w_king, pawn + 16)];
+                }
+                r = (r & KPK_WIN) ? KPK_WIN : (r & KPK_UNKNOWN) ? KPK_UNKNOWN : KPK_DRAW;
+            } else {
+                uint64_t moves = MoveGen::BB_KING_ATTACKS[b_king];
+                while (moves) {
+                    r |= results[Endgame::kpkIndex(true, BitUtils::pullLSB(&moves), w_king, pawn)];
+                }
+                r = (r & KPK_DRAW) ? KPK_DRAW : (r & KPK_UNKNOWN) ? KPK_UNKNOWN : KPK_WIN;
+            }
+            if (r != KPK_UNKNOWN) {
+                results[i] = r;
+                changed = true;
+            }
+        }
+    }
+
+    for (int i = 0; i < Endgame::KPK_SIZE; ++i) {
+        if (results[i] == KPK_WIN) {
+            Endgame::KPK_BITBASE[i / 64] |= 1ULL << (i % 64);
+        } else {
+            Endgame::KPK_BITBASE[i / 64] &= ~(1ULL << (i % 64));
+        }
+    }
+}
+
+/**
+ * @return the endgame material of the side, pawns included.
+ */
+static int32_t endgameMaterial(const Bitboard &board, bool color) {
+    int32_t material = 0;
+    for (int type = Bitboard::PAWN; type < Bitboard::KING; ++type) {
+        material += Weights::Endgame::MATERIAL[type] * BitUtils::popCount(board.pieces(color, (Bitboard::piece_type_t) type));
+    }
+    return material;
+}
+
+int32_t Endgame::KXK(const Bitboard &board, bool strong_side) {
+    const int strong_king = BitUtils::getLSB(board.pieces(strong_side, Bitboard::KING));
+    const int weak_king = BitUtils::getLSB(board.pieces(!strong_side, Bitboard::KING));
+
+    int32_t score = endgameMaterial(board, strong_side) + Endgame::pushToEdge(weak_king) +
+                    Endgame::pushClose(strong_king, weak_king);
+
+    /** Bishops of a single color cannot mate without help */
+    const uint64_t bishops = board.pieces(strong_side, Bitboard::BISHOP);
+    if (board.pieces(strong_side, Bitboard::QUEEN) || board.pieces(strong_side, Bitboard::ROOK) ||
+        board.pieces(strong_side, Bitboard::PAWN) || board.pieces(strong_side, Bitboard::KNIGHT) ||
+        ((bishops & Bitboard::BB_LIGHT_SQUARES) && (bishops & ~Bitboard::BB_LIGHT_SQUARES))) {
+        score += Endgame::KNOWN_WIN;
+    }
+    return score;
+}
+
+int32_t Endgame::KBNK(const Bitboard &board, bool strong_side) {
+    const int strong_king = BitUtils::getLSB(board.pieces(strong_side, Bitboard::KING));
+    int weak_king = BitUtils::getLSB(board.pieces(!strong_side, Bitboard::KING));
+
+    /** Mirror a light squared bishop's corners a8 and h1 onto the dark corners a1 and h8 */
+    if (board.pieces(strong_side, Bitboard::BISHOP) & Bitboard::BB_LIGHT_SQUARES) {
+        weak_king ^= 7;
+    }
+    const int32_t corner = std::abs(7 - Bitboard::fileOf(weak_king) - Bitboard::rankOf(weak_king));
+
+    return Endgame::KNOWN_WIN + endgameMaterial(board, strong_side) + 40 * corner +
+           Endgame::pushClose(strong_king, BitUtils::getLSB(board.pieces(!strong_side, Bitboard::KING)));
+}
+
+int32_t Endgame::KPK(const Bitboard &board, bool strong_side) {
+    int w_king = BitUtils::getLSB(board.pieces(strong_side, Bitboard::KING));
+    int b_king = BitUtils::getLSB(board.pieces(!strong_side, Bitboard::KING));
+    int pawn = BitUtils::getLSB(board.pieces(strong_side, Bitboard::PAWN));
+
+    /** Flip the board so that the pawn is white and on files a to d */
+    if (strong_side == BLACK) {
+        w_king ^= 56;
+        b_king ^= 56;
+        pawn ^= 56;
+    }
+    if (Bitboard::fileOf(pawn) >= 4) {
+        w_king ^= 7;
+        b_king ^= 7;
+        pawn ^= 7;
+    }
+
+    std::call_once(kpk_built, Endgame::buildKPK);
+    const int i = Endgame::kpkIndex(board.getTurn() == strong_side, b_king, w_king, pawn);
+    if (!(Endgame::KPK_BITBASE[i / 64] & (1ULL << (i % 64)))) {
+        return 0;
+    }
+    return Endgame::KNOWN_WIN + Weights::Endgame::MATERIAL[Bitboard::PAWN] + 10 * Bitboard::rankOf(pawn);
+}
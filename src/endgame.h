@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bitboard.h"
+
+/**
+ * Evaluators of endgames the general evaluation misjudges, selected by the material table. Each scores the
+ * position from the point of view of the side with the winning material, as an endgame_fn.
+ *
+ * KPK is looked up in a bitbase of every position with the pawn on files a to d, built by retrograde
+ * analysis on the first probe. The rest drive the losing king where the winning side can mate it.
+ */
+struct Endgame {
+
+    // Above any score the general evaluation reaches, below the mate scores
+    static const int32_t KNOWN_WIN = 10000;
+
+    /**
+     * King and pieces worth at least a rook against a lone king: KRK, KQK and the like.
+     */
+    static int32_t KXK(const Bitboard &board, bool strong_side);
+
+    /**
+     * King, bishop and knight against a lone king, mated only in a corner of the bishop's color.
+     */
+    static int32_t KBNK(const Bitboard &board, bool strong_side);
+
+    /**
+     * King and pawn against a lone king, exact from the bitbase.
+     */
+    static int32_t KPK(const Bitboard &board, bool strong_side);
+
+private:
+
+    static const int KPK_SIZE = 2 * 24 * 64 * 64;
+
+    // Bit set if the side with the pawn wins, indexed by kpkIndex
+    static uint64_t KPK_BITBASE[KPK_SIZE / 64];
+
+    /**
+     * Fills the KPK bitbase, about 35 ms. Called once, by the first KPK probe.
+     */
+    static void buildKPK();
+
+    /**
+     * @return the bitbase index of a position with a white pawn on files a to d.
+     */
+    static int kpkIndex(bool white_to_move, int b_king, int w_king, int pawn);
+
+    static int distance(int from, int to);
+
+    /**
+     * @return a bonus for the king standing nearer the edge of the board.
+     */
+    static int32_t pushToEdge(int square);
+
+    /**
+     * @return a bonus for the kings standing close to each other.
+     */
+    static int32_t pushClose(int from, int to);
+};
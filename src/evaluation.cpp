@@ -1,4 +1,5 @@
 #include "bitboard.h"
+#include "endgame.h"
 #include "evaluation.h"
 #include "movegen.h"
 #include "weights.h"
@@ -7,34 +8,14 @@
 #include <cmath>
 #include <cstring>
 
-namespace Weights {
-
-    const int32_t (&PAWN_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_PAWN];
-    const int32_t (&KNIGHT_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_KNIGHT];
-    const int32_t (&BISHOP_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_BISHOP];
-    const int32_t (&ROOK_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_ROOK];
-    const int32_t (&QUEEN_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_QUEEN];
-    const int32_t (&KING_PSQT)[64] = Weights::PSQTs[piece_t::BLACK_KING];
-
-    namespace Endgame {
-        const int32_t (&PAWN_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_PAWN];
-        const int32_t (&KNIGHT_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_KNIGHT];
-        const int32_t (&BISHOP_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_BISHOP];
-        const int32_t (&ROOK_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_ROOK];
-        const int32_t (&QUEEN_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_QUEEN];
-        const int32_t (&KING_PSQT)[64] = Weights::Endgame::PSQTs[piece_t::BLACK_KING];
-    }
-}
-
 Evaluation::Evaluation(const Bitboard *board) {
     this->board = board;
 }
 
 void Evaluation::reset() {
-    midgame_score = 0;
-    endgame_score = 0;
-    w_pawn_rearspans = whitePawnsRearspan(this->board->wPawns, 0ULL);
-    b_pawn_rearspans = blackPawnsRearspan(this->board->bPawns, 0ULL);
+    /** Material and piece-square values are kept up to date by the board as pieces move */
+    midgame_score = this->board->midgameScore;
+    endgame_score = this->board->endgameScore;
     countOpenFiles();
     whiteSpaceBonus();
     blackSpaceBonus();
@@ -116,24 +97,19 @@ uint64_t Evaluation::blackPawnsRearspan(uint64_t pawns_bb, uint64_t occupied_bb)
 }
 
 double Evaluation::gamePhase() {
-    phase = 0;
-    phase += BitUtils::popCount(this->board->wPawns | this->board->bPawns) * Weights::PAWN_PHASE;
-    phase += BitUtils::popCount(this->board->wKnights | this->board->bKnights) * Weights::KNIGHT_PHASE;
-    phase += BitUtils::popCount(this->board->wBishops | this->board->bBishops) * Weights::BISHOP_PHASE;
-    phase += BitUtils::popCount(this->board->wRooks | this->board->bRooks) * Weights::ROOK_PHASE;
-    phase += BitUtils::popCount(this->board->wQueens | this->board->bQueens) * Weights::QUEEN_PHASE;
+    phase = this->board->phase;
     return ((double) phase) / Weights::TOTAL_PHASE;
 }
 
 void Evaluation::whiteSpaceBonus() {
-    int n_pieces = BitUtils::popCount(this->board->wRooks) + BitUtils::popCount(this->board->wKnights)
-                   + BitUtils::popCount(this->board->wBishops) + BitUtils::popCount(this->board->wQueens);
+    int n_pieces = BitUtils::popCount(this->board->pieces(WHITE, Bitboard::ROOK)) + BitUtils::popCount(this->board->pieces(WHITE, Bitboard::KNIGHT))
+                   + BitUtils::popCount(this->board->pieces(WHITE, Bitboard::BISHOP)) + BitUtils::popCount(this->board->pieces(WHITE, Bitboard::QUEEN));
     w_space_bonus = n_pieces - n_open_files;
 }
 
 void Evaluation::blackSpaceBonus() {
-    int n_pieces = BitUtils::popCount(this->board->bRooks) + BitUtils::popCount(this->board->bKnights) +
-                   BitUtils::popCount(this->board->bBishops) + BitUtils::popCount(this->board->bQueens);
+    int n_pieces = BitUtils::popCount(this->board->pieces(BLACK, Bitboard::ROOK)) + BitUtils::popCount(this->board->pieces(BLACK, Bitboard::KNIGHT)) +
+                   BitUtils::popCount(this->board->pieces(BLACK, Bitboard::BISHOP)) + BitUtils::popCount(this->board->pieces(BLACK, Bitboard::QUEEN));
     b_space_bonus = n_pieces - n_open_files;
 }
 
@@ -148,14 +124,17 @@ void Evaluation::countOpenFiles() {
 }
 
 int32_t Evaluation::evaluate() {
-    reset();
-    materialScore();
-    PSQTs();
+    const MaterialEntry &material = probeMaterial();
+    if (material.endgame) {
+        /** Known endgames are scored by their own evaluator alone */
+        const int32_t score = material.endgame(*this->board, material.strongSide);
+        return this->board->getTurn() == material.strongSide ? score : -score;
+    }
 
-    pawnStructure();
-    passedPawns();
-    doubledPawns();
-    backwardPawns();
+    reset();
+    midgame_score += material.midgameImbalance;
+    endgame_score += material.endgameImbalance;
+    evaluatePawns();
     rook_activity();
     queen_activity();
     evaluateSpace();
@@ -165,73 +144,134 @@ int32_t Evaluation::evaluate() {
     }
     int32_t s = weightedScore();
     //std::cout << "score: " << s << '\n';
-    return s;
+
+    /** Scale down the score when the side it favors can rarely win */
+    const bool favored = s > 0 ? this->board->getTurn() : !this->board->getTurn();
+    return s * material.scale[favored] / MaterialEntry::SCALE_NORMAL;
+}
+
+const MaterialEntry &Evaluation::probeMaterial() {
+    const uint64_t key = this->board->material_key;
+    MaterialEntry &entry = this->materialTable.probe(key);
+    if (entry.key != key) {
+        computeMaterial(entry, key);
+    }
+    return entry;
+}
+
+void Evaluation::computeMaterial(MaterialEntry &entry, uint64_t material_key) {
+    /** Piece counts indexed by color and piece_type_t, unpacked from the material key */
+    int count[2][6];
+    int32_t non_pawn_material[2] = {0, 0};
+    for (int type = Bitboard::PAWN; type <= Bitboard::KING; ++type) {
+        count[BLACK][type] = (int) ((material_key >> (4 * (piece_t::BLACK_PAWN + type))) & 0xf);
+        count[WHITE][type] = (int) ((material_key >> (4 * (piece_t::WHITE_PAWN + type))) & 0xf);
+        if (type != Bitboard::PAWN) {
+            non_pawn_material[BLACK] += count[BLACK][type] * Weights::MATERIAL[type];
+            non_pawn_material[WHITE] += count[WHITE][type] * Weights::MATERIAL[type];
+        }
+    }
+
+    entry.key = material_key;
+    entry.midgameImbalance = Weights::BISHOP_PAIR * ((count[WHITE][Bitboard::BISHOP] >= 2) - (count[BLACK][Bitboard::BISHOP] >= 2));
+    entry.endgameImbalance = Weights::Endgame::BISHOP_PAIR * ((count[WHITE][Bitboard::BISHOP] >= 2) - (count[BLACK][Bitboard::BISHOP] >= 2));
+    entry.scale[WHITE] = MaterialEntry::SCALE_NORMAL;
+    entry.scale[BLACK] = MaterialEntry::SCALE_NORMAL;
+    entry.endgame = nullptr;
+    entry.strongSide = WHITE;
+
+    for (int side = BLACK; side <= WHITE; ++side) {
+        const int *us = count[side], *them = count[!side];
+        const int32_t npm = non_pawn_material[side], their_npm = non_pawn_material[!side];
+        const bool two_knights = !us[Bitboard::PAWN] && us[Bitboard::KNIGHT] == 2 && npm == 2 * Weights::MATERIAL[Bitboard::KNIGHT];
+
+        if (!them[Bitboard::PAWN] && !their_npm) {
+            /** Against a lone king */
+            if (!us[Bitboard::PAWN] && npm == Weights::MATERIAL[Bitboard::KNIGHT] + Weights::MATERIAL[Bitboard::BISHOP] &&
+                us[Bitboard::KNIGHT] == 1) {
+                entry.endgame = &Endgame::KBNK;
+            } else if (npm >= Weights::MATERIAL[Bitboard::ROOK] && !two_knights) {
+                entry.endgame = &Endgame::KXK;
+            } else if (us[Bitboard::PAWN] == 1 && !npm) {
+                entry.endgame = &Endgame::KPK;
+            }
+            if (entry.endgame) {
+                entry.strongSide = side;
+                return;
+            }
+        }
+
+        /** Without pawns, a side at most a minor piece ahead can rarely win, and two knights cannot force mate */
+        if (!us[Bitboard::PAWN] && npm - their_npm <= Weights::MATERIAL[Bitboard::BISHOP]) {
+            entry.scale[side] = npm < Weights::MATERIAL[Bitboard::ROOK] ? 0 : their_npm <= Weights::MATERIAL[Bitboard::BISHOP] ? 4 : 14;
+        } else if (two_knights && !them[Bitboard::PAWN]) {
+            entry.scale[side] = 0;
+        }
+    }
 }
 
-void Evaluation::materialScore() {
-    /** White Material Score */
-    int n = BitUtils::popCount(this->board->wPawns);
-    midgame_score += n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_PAWN)];
-    endgame_score += n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_PAWN)];
-    n = BitUtils::popCount(this->board->wKnights);
-    midgame_score += n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_KNIGHT)];
-    endgame_score += n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_KNIGHT)];
-    n = BitUtils::popCount(this->board->wBishops);
-    midgame_score += n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_BISHOP)];
-    endgame_score += n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_BISHOP)];
-    n = BitUtils::popCount(this->board->wRooks);
-    midgame_score += n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_ROOK)];
-    endgame_score += n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_ROOK)];
-    n = BitUtils::popCount(this->board->wQueens);
-    midgame_score += n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_QUEEN)];
-    endgame_score += n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_QUEEN)];
-
-    /** Black material score */
-    n = BitUtils::popCount(this->board->bPawns);
-    midgame_score -= n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_PAWN)];
-    endgame_score -= n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_PAWN)];
-    n = BitUtils::popCount(this->board->bKnights);
-    midgame_score -= n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_KNIGHT)];
-    endgame_score -= n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_KNIGHT)];
-    n = BitUtils::popCount(this->board->bBishops);
-    midgame_score -= n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_BISHOP)];
-    endgame_score -= n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_BISHOP)];
-    n = BitUtils::popCount(this->board->bRooks);
-    midgame_score -= n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_ROOK)];
-    endgame_score -= n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_ROOK)];
-    n = BitUtils::popCount(this->board->bQueens);
-    midgame_score -= n * Weights::MATERIAL[static_cast<size_t> (piece_t::BLACK_QUEEN)];
-    endgame_score -= n * Weights::Endgame::MATERIAL[static_cast<size_t> (piece_t::BLACK_QUEEN)];
+void Evaluation::evaluatePawns() {
+    const uint64_t key = this->board->pawn_hash_code;
+    PawnEntry &entry = this->pawnTable.probe(key);
+    if (entry.key != key) {
+        /** Score the pawn terms alone, so that they can be stored apart from the rest of the evaluation */
+        const int32_t mg = midgame_score, eg = endgame_score;
+        midgame_score = 0;
+        endgame_score = 0;
+        w_pawn_rearspans = whitePawnsRearspan(this->board->pieces(WHITE, Bitboard::PAWN), 0ULL);
+        b_pawn_rearspans = blackPawnsRearspan(this->board->pieces(BLACK, Bitboard::PAWN), 0ULL);
+        w_pawn_attacks = MoveGen::get_pawn_attacks_setwise(this->board->pieces(WHITE, Bitboard::PAWN), WHITE);
+        b_pawn_attacks = MoveGen::get_pawn_attacks_setwise(this->board->pieces(BLACK, Bitboard::PAWN), BLACK);
+        pawnStructure();
+        passedPawns();
+        doubledPawns();
+        backwardPawns();
+
+        entry.key = key;
+        entry.midgameScore = midgame_score;
+        entry.endgameScore = endgame_score;
+        entry.rearspans[WHITE] = w_pawn_rearspans;
+        entry.rearspans[BLACK] = b_pawn_rearspans;
+        entry.attacks[WHITE] = w_pawn_attacks;
+        entry.attacks[BLACK] = b_pawn_attacks;
+        midgame_score += mg;
+        endgame_score += eg;
+        return;
+    }
+    midgame_score += entry.midgameScore;
+    endgame_score += entry.endgameScore;
+    w_pawn_rearspans = entry.rearspans[WHITE];
+    b_pawn_rearspans = entry.rearspans[BLACK];
+    w_pawn_attacks = entry.attacks[WHITE];
+    b_pawn_attacks = entry.attacks[BLACK];
 }
 
 void Evaluation::pawnStructure() {
-    uint64_t pawn_attacks = MoveGen::get_pawn_attacks_setwise(this->board->wPawns, WHITE);
-    whiteCharacteristic(BitUtils::popCount(pawn_attacks & this->board->wPawns),
+    whiteCharacteristic(BitUtils::popCount(w_pawn_attacks & this->board->pieces(WHITE, Bitboard::PAWN)),
                                 Evaluation::characteristic_t::PAWN_CHAIN);
 
-    pawn_attacks = MoveGen::get_pawn_attacks_setwise(this->board->bPawns, BLACK);
-    blackCharacteristic(BitUtils::popCount(pawn_attacks & this->board->bPawns), Evaluation::characteristic_t::PAWN_CHAIN);
+    blackCharacteristic(BitUtils::popCount(b_pawn_attacks & this->board->pieces(BLACK, Bitboard::PAWN)), Evaluation::characteristic_t::PAWN_CHAIN);
 }
 
 void Evaluation::doubledPawns() {
     uint64_t mask = Bitboard::BB_FILE_A;
     for (int i = 0; i < 8; ++i) {
         /** Calculates (number of pawns in a file - 1) and penalizes accordingly */
-        whiteCharacteristic(std::max(BitUtils::popCount(this->board->wPawns & mask) - 1, 0),
+        whiteCharacteristic(std::max(BitUtils::popCount(this->board->pieces(WHITE, Bitboard::PAWN) & mask) - 1, 0),
                                     Evaluation::characteristic_t::DOUBLED_PAWNS);
         /** Shifts bitmask one file right */
         mask <<= 1;
     }
     mask = Bitboard::BB_FILE_A;
     for (int i = 0; i < 8; ++i) {
-        blackCharacteristic(std::max((BitUtils::popCount(this->board->bPawns & mask) - 1), 0),
+        blackCharacteristic(std::max((BitUtils::popCount(this->board->pieces(BLACK, Bitboard::PAWN) & mask) - 1), 0),
                                     Evaluation::characteristic_t::DOUBLED_PAWNS);
         mask <<= 1;
     }
 }
 
 void Evaluation::passedPawns() {
-    uint64_t frontspans = whitePawnsFrontspan(this->board->wPawns, this->board->bPawns);
+    uint64_t frontspans = whitePawnsFrontspan(this->board->pieces(WHITE, Bitboard::PAWN), this->board->pieces(BLACK, Bitboard::PAWN));
 
     uint64_t promSquare_mask = Bitboard::BB_FILE_A & Bitboard::BB_RANK_8;
     uint64_t file_mask = Bitboard::BB_FILE_A;
@@ -241,15 +281,15 @@ void Evaluation::passedPawns() {
             uint64_t left_file = (frontspans & file_mask) >> 1;
             uint64_t right_file = (frontspans & file_mask) << 1;
 
-            n += ((left_file & (this->board->bPawns | Bitboard::BB_FILE_H)) == 0);
-            n += ((right_file & (this->board->bPawns | Bitboard::BB_FILE_A)) == 0);
+            n += ((left_file & (this->board->pieces(BLACK, Bitboard::PAWN) | Bitboard::BB_FILE_H)) == 0);
+            n += ((right_file & (this->board->pieces(BLACK, Bitboard::PAWN) | Bitboard::BB_FILE_A)) == 0);
             whiteCharacteristic(n, Evaluation::characteristic_t::PASSED_PAWN);
         }
         promSquare_mask <<= 1;
         file_mask <<= 1;
     }
 
-    frontspans = blackPawnsFrontspan(this->board->bPawns, this->board->wPawns);
+    frontspans = blackPawnsFrontspan(this->board->pieces(BLACK, Bitboard::PAWN), this->board->pieces(WHITE, Bitboard::PAWN));
     promSquare_mask = Bitboard::BB_FILE_A & Bitboard::BB_RANK_1;
     file_mask = Bitboard::BB_FILE_A;
     for (int i = 0; i < 8; ++i) {
@@ -258,8 +298,8 @@ void Evaluation::passedPawns() {
             uint64_t left_file = (frontspans & file_mask) >> 1;
             uint64_t right_file = (frontspans & file_mask) << 1;
 
-            n += ((left_file & (this->board->wPawns | Bitboard::BB_FILE_H)) == 0);
-            n += ((right_file & (this->board->wPawns | Bitboard::BB_FILE_A)) == 0);
+            n += ((left_file & (this->board->pieces(WHITE, Bitboard::PAWN) | Bitboard::BB_FILE_H)) == 0);
+            n += ((right_file & (this->board->pieces(WHITE, Bitboard::PAWN) | Bitboard::BB_FILE_A)) == 0);
             blackCharacteristic(n, Evaluation::characteristic_t::PASSED_PAWN);
         }
         promSquare_mask <<= 1;
@@ -268,7 +308,7 @@ void Evaluation::passedPawns() {
 }
 
 void Evaluation::backwardPawns() {
-    uint64_t rearspans = whitePawnsRearspan(this->board->wPawns, 0ULL);
+    uint64_t rearspans = w_pawn_rearspans;
     uint64_t file_mask = Bitboard::BB_FILE_A;
     for (int i = 0; i < 8; ++i) {
         uint64_t rear_file = rearspans & file_mask;
@@ -276,22 +316,22 @@ void Evaluation::backwardPawns() {
             /** If there exists a pawn in the file */
             uint64_t left_potential_guards = (rear_file >> 1) & ~Bitboard::BB_FILE_H;
             uint64_t right_potential_guards = (rear_file << 1) & Bitboard::BB_FILE_A;
-            bool left_guardless = ((left_potential_guards & this->board->wPawns) == 0);
-            bool right_guardless = ((right_potential_guards & this->board->wPawns) == 0);
+            bool left_guardless = ((left_potential_guards & this->board->pieces(WHITE, Bitboard::PAWN)) == 0);
+            bool right_guardless = ((right_potential_guards & this->board->pieces(WHITE, Bitboard::PAWN)) == 0);
             whiteCharacteristic((int) (left_guardless & right_guardless),
                                         Evaluation::characteristic_t::BACKWARD_PAWN);
         }
         file_mask <<= 1;
     }
-    rearspans = blackPawnsRearspan(this->board->bPawns, 0ULL);
+    rearspans = b_pawn_rearspans;
     file_mask = Bitboard::BB_FILE_A;
     for (int i = 0; i < 8; ++i) {
         uint64_t rear_file = rearspans & file_mask;
         if (rear_file) {
             uint64_t left_potential_guards = (rear_file >> 1) & ~Bitboard::BB_FILE_H;
             uint64_t right_potential_guards = (rear_file << 1) & Bitboard::BB_FILE_A;
-            bool left_guardless = ((left_potential_guards & this->board->bPawns) == 0);
-            bool right_guardless = ((right_potential_guards & this->board->bPawns) == 0);
+            bool left_guardless = ((left_potential_guards & this->board->pieces(BLACK, Bitboard::PAWN)) == 0);
+            bool right_guardless = ((right_potential_guards & this->board->pieces(BLACK, Bitboard::PAWN)) == 0);
             blackCharacteristic((int) (left_guardless & right_guardless),
                                         Evaluation::characteristic_t::BACKWARD_PAWN);
         }
@@ -300,14 +340,14 @@ void Evaluation::backwardPawns() {
 }
 
 void Evaluation::rook_activity() {
-    uint64_t data = MoveGen::get_rook_rays_setwise(this->board->wRooks, ~(this->board->occupied ^ this->board->wRooks));
+    uint64_t data = MoveGen::get_rook_rays_setwise(this->board->pieces(WHITE, Bitboard::ROOK), ~(this->board->occupied ^ this->board->pieces(WHITE, Bitboard::ROOK)));
     /** Detection of connected rooks */
-    whiteCharacteristic(std::max((BitUtils::popCount(data & this->board->wRooks) - 1), 0),
+    whiteCharacteristic(std::max((BitUtils::popCount(data & this->board->pieces(WHITE, Bitboard::ROOK)) - 1), 0),
                                 Evaluation::characteristic_t::CONNECTED_ROOKS);
 
     /** The following repeats the same score for black*/
-    data = MoveGen::get_rook_rays_setwise(this->board->bRooks, ~(this->board->occupied ^ this->board->bRooks));
-    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->bRooks) - 1, 0),
+    data = MoveGen::get_rook_rays_setwise(this->board->pieces(BLACK, Bitboard::ROOK), ~(this->board->occupied ^ this->board->pieces(BLACK, Bitboard::ROOK)));
+    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->pieces(BLACK, Bitboard::ROOK)) - 1, 0),
                                 Evaluation::characteristic_t::CONNECTED_ROOKS);
 }
 
@@ -315,24 +355,24 @@ void Evaluation::queen_activity() {
     /**
      *  @var uint64_t data Stores a bitboard of all squares hit by any white queen.
      */
-    uint64_t data = MoveGen::get_queen_rays_setwise(this->board->wQueens,
-                                           ~(this->board->occupied ^ this->board->wQueens ^ this->board->wRooks ^ this->board->wBishops));
+    uint64_t data = MoveGen::get_queen_rays_setwise(this->board->pieces(WHITE, Bitboard::QUEEN),
+                                           ~(this->board->occupied ^ this->board->pieces(WHITE, Bitboard::QUEEN) ^ this->board->pieces(WHITE, Bitboard::ROOK) ^ this->board->pieces(WHITE, Bitboard::BISHOP)));
 
     /** Detects Queen-Rook batteries. */
-    whiteCharacteristic(std::max(BitUtils::popCount(data & this->board->wRooks) - 1, 0),
+    whiteCharacteristic(std::max(BitUtils::popCount(data & this->board->pieces(WHITE, Bitboard::ROOK)) - 1, 0),
                                 Evaluation::characteristic_t::QUEEN_ROOK);
 
     /** Detects Queen-Bishop batteries. */
-    whiteCharacteristic(std::max(BitUtils::popCount(data & this->board->wBishops) - 1, 0),
+    whiteCharacteristic(std::max(BitUtils::popCount(data & this->board->pieces(WHITE, Bitboard::BISHOP)) - 1, 0),
                                 Evaluation::characteristic_t::QUEEN_BISHOP);
 
     /** Evaluates queen placement using piece-square table */
 
     /** Following code duplicates the above functionality for black */
-    data = MoveGen::get_queen_rays_setwise(this->board->bQueens, ~(this->board->occupied ^ this->board->bQueens ^ this->board->bRooks ^ this->board->bBishops));
-    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->bRooks) - 1, 0),
+    data = MoveGen::get_queen_rays_setwise(this->board->pieces(BLACK, Bitboard::QUEEN), ~(this->board->occupied ^ this->board->pieces(BLACK, Bitboard::QUEEN) ^ this->board->pieces(BLACK, Bitboard::ROOK) ^ this->board->pieces(BLACK, Bitboard::BISHOP)));
+    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->pieces(BLACK, Bitboard::ROOK)) - 1, 0),
                                 Evaluation::characteristic_t::QUEEN_ROOK);
-    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->bBishops) - 1, 0),
+    blackCharacteristic(std::max(BitUtils::popCount(data & this->board->pieces(BLACK, Bitboard::BISHOP)) - 1, 0),
                                 Evaluation::characteristic_t::QUEEN_BISHOP);
 }
 
@@ -388,7 +428,7 @@ void Evaluation::king_placement() {
 void Evaluation::evaluateSpace() {
     /** Accumulate guard values of white pieces */
     uint64_t attacks = MoveGen::BB_KING_ATTACKS[this->board->wKingSquare];
-    uint64_t king_vulnerabilities = this->kingVulnerabilities(this->board->bKing, this->board->bPawns);
+    uint64_t king_vulnerabilities = this->kingVulnerabilities(this->board->pieces(BLACK, Bitboard::KING), this->board->pieces(BLACK, Bitboard::PAWN));
     int32_t mg_king_danger = 0;
     int32_t eg_king_danger = 0;
     int n_attackers = 0;
@@ -397,7 +437,7 @@ void Evaluation::evaluateSpace() {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] += Weights::GUARD_VALUE[piece_t::BLACK_KING];
     }
-    attacks = MoveGen::get_queen_rays_setwise(this->board->wQueens, ~this->board->occupied) & (~this->board->wQueens);
+    attacks = MoveGen::get_queen_rays_setwise(this->board->pieces(WHITE, Bitboard::QUEEN), ~this->board->occupied) & (~this->board->pieces(WHITE, Bitboard::QUEEN));
     this->accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
@@ -405,28 +445,28 @@ void Evaluation::evaluateSpace() {
         square_guard_values[i] += Weights::GUARD_VALUE[piece_t::BLACK_QUEEN];
     }
 
-    attacks = MoveGen::get_rook_rays_setwise(this->board->wRooks, ~this->board->occupied) & (~this->board->wRooks);
+    attacks = MoveGen::get_rook_rays_setwise(this->board->pieces(WHITE, Bitboard::ROOK), ~this->board->occupied) & (~this->board->pieces(WHITE, Bitboard::ROOK));
     this->accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] += Weights::GUARD_VALUE[piece_t::BLACK_ROOK];
     }
-    attacks = MoveGen::get_bishop_rays_setwise(this->board->wBishops, ~this->board->occupied) & (~this->board->wBishops);
+    attacks = MoveGen::get_bishop_rays_setwise(this->board->pieces(WHITE, Bitboard::BISHOP), ~this->board->occupied) & (~this->board->pieces(WHITE, Bitboard::BISHOP));
     this->accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] += Weights::GUARD_VALUE[piece_t::BLACK_BISHOP];
     }
-    attacks = MoveGen::get_knight_mask_setwise(this->board->wKnights);
+    attacks = MoveGen::get_knight_mask_setwise(this->board->pieces(WHITE, Bitboard::KNIGHT));
     this->accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] += Weights::GUARD_VALUE[piece_t::BLACK_KNIGHT];
     }
-    attacks = MoveGen::get_pawn_attacks_setwise(board->wPawns, WHITE);
+    attacks = w_pawn_attacks;
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     midgame_score += n_attackers * mg_king_danger;
@@ -440,7 +480,7 @@ void Evaluation::evaluateSpace() {
     mg_king_danger = 0;
     eg_king_danger = 0;
     n_attackers = 0;
-    king_vulnerabilities = kingVulnerabilities(this->board->wKing, this->board->wPawns);
+    king_vulnerabilities = kingVulnerabilities(this->board->pieces(WHITE, Bitboard::KING), this->board->pieces(WHITE, Bitboard::PAWN));
 
     /** Accumulate guard values of black pieces */
     attacks = MoveGen::BB_KING_ATTACKS[this->board->bKingSquare];
@@ -448,35 +488,35 @@ void Evaluation::evaluateSpace() {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] -= Weights::GUARD_VALUE[piece_t::BLACK_KING];
     }
-    attacks = MoveGen::get_queen_rays_setwise(this->board->bQueens, ~this->board->occupied) & (~this->board->bQueens);
+    attacks = MoveGen::get_queen_rays_setwise(this->board->pieces(BLACK, Bitboard::QUEEN), ~this->board->occupied) & (~this->board->pieces(BLACK, Bitboard::QUEEN));
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] -= Weights::GUARD_VALUE[piece_t::BLACK_QUEEN];
     }
-    attacks = MoveGen::get_rook_rays_setwise(this->board->bRooks, ~this->board->occupied) & (~this->board->bRooks);
+    attacks = MoveGen::get_rook_rays_setwise(this->board->pieces(BLACK, Bitboard::ROOK), ~this->board->occupied) & (~this->board->pieces(BLACK, Bitboard::ROOK));
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] -= Weights::GUARD_VALUE[piece_t::BLACK_ROOK];
     }
-    attacks = MoveGen::get_bishop_rays_setwise(this->board->bBishops, ~this->board->occupied) & (~this->board->bBishops);
+    attacks = MoveGen::get_bishop_rays_setwise(this->board->pieces(BLACK, Bitboard::BISHOP), ~this->board->occupied) & (~this->board->pieces(BLACK, Bitboard::BISHOP));
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] -= Weights::GUARD_VALUE[piece_t::BLACK_BISHOP];
     }
-    attacks = MoveGen::get_knight_mask_setwise(this->board->bKnights);
+    attacks = MoveGen::get_knight_mask_setwise(this->board->pieces(BLACK, Bitboard::KNIGHT));
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
         int i = BitUtils::pullLSB(&attacks);
         square_guard_values[i] -= Weights::GUARD_VALUE[piece_t::BLACK_KNIGHT];
     }
-    attacks = MoveGen::get_pawn_attacks_setwise(this->board->bPawns, BLACK);
+    attacks = b_pawn_attacks;
     accumulateKingThreats(n_attackers, mg_king_danger, eg_king_danger, attacks, king_vulnerabilities);
 
     while (attacks) {
@@ -495,8 +535,8 @@ void Evaluation::evaluateSpace() {
      * Implemented as, guard_values[i] = sgn(guard_values[i]).
      */
 
-    uint64_t w_king_surroundings = kingVulnerabilities(this->board->wKing, 0ULL);
-    uint64_t b_king_surroundings = kingVulnerabilities(this->board->bKing, 0ULL);
+    uint64_t w_king_surroundings = kingVulnerabilities(this->board->pieces(WHITE, Bitboard::KING), 0ULL);
+    uint64_t b_king_surroundings = kingVulnerabilities(this->board->pieces(BLACK, Bitboard::KING), 0ULL);
     uint64_t examinedSquare = 1ULL;
     for (int i = 0; i < 64; ++i) {
         /** Sets square_guard_values[i] = sign(square_guard_values[i]) */
@@ -523,38 +563,6 @@ void Evaluation::accumulateKingThreats(int &n_attackers, int32_t &mg_score, int3
     n_attackers += (pop_cnt > 0);
 }
 
-void Evaluation::PSQTs() {
-    whitePSQT(this->board->wPawns, Weights::PAWN_PSQT, Weights::Endgame::PAWN_PSQT);
-    whitePSQT(this->board->wKnights, Weights::KNIGHT_PSQT, Weights::Endgame::KNIGHT_PSQT);
-    whitePSQT(this->board->wBishops, Weights::BISHOP_PSQT, Weights::Endgame::BISHOP_PSQT);
-    whitePSQT(this->board->wRooks, Weights::ROOK_PSQT, Weights::Endgame::ROOK_PSQT);
-    whitePSQT(this->board->wQueens, Weights::QUEEN_PSQT, Weights::Endgame::QUEEN_PSQT);
-    whitePSQT(this->board->wKing, Weights::KING_PSQT, Weights::Endgame::KING_PSQT);
-
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bPawns), Weights::PAWN_PSQT, Weights::Endgame::PAWN_PSQT);
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bKnights), Weights::KNIGHT_PSQT, Weights::Endgame::KNIGHT_PSQT);
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bBishops), Weights::BISHOP_PSQT, Weights::Endgame::BISHOP_PSQT);
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bRooks), Weights::ROOK_PSQT, Weights::Endgame::ROOK_PSQT);
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bQueens), Weights::QUEEN_PSQT, Weights::Endgame::QUEEN_PSQT);
-    blackPSQT(BitUtils::flipBitboardVertical(this->board->bKing), Weights::KING_PSQT, Weights::Endgame::KING_PSQT);
-}
-
-void Evaluation::whitePSQT(uint64_t bb, const int32_t mg_psqt[64], const int32_t eg_psqt[64]) {
-    while (bb) {
-        int i = BitUtils::pullLSB(&bb);
-        midgame_score += mg_psqt[i];
-        endgame_score += eg_psqt[i];
-    }
-}
-
-void Evaluation::blackPSQT(uint64_t bb, const int32_t mg_psqt[64], const int32_t eg_psqt[64]) {
-    while (bb) {
-        int i = BitUtils::pullLSB(&bb);
-        midgame_score -= mg_psqt[i];
-        endgame_score -= eg_psqt[i];
-    }
-}
-
 void Evaluation::whiteCharacteristic(int n, Evaluation::characteristic_t type) {
     midgame_score += (n * Weights::POSITIONAL[static_cast<size_t> (type)]);
     endgame_score += (n * Weights::Endgame::POSITIONAL[static_cast<size_t> (type)]);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include "tables.h"
 #include "util.h"
 
 struct Evaluation {
@@ -26,7 +27,12 @@ private:
 
     uint16_t phase;
 
+    PawnTable pawnTable;
+
+    MaterialTable materialTable;
+
     uint64_t w_pawn_rearspans, b_pawn_rearspans;
+    uint64_t w_pawn_attacks, b_pawn_attacks;
 
     int32_t n_open_files;
     int32_t w_space_bonus, b_space_bonus;
@@ -56,7 +62,22 @@ private:
 
     /** Determine score of position */
 
-    void materialScore();
+    /**
+     * @return the material terms of the position, from the material table when the material was seen before.
+     */
+    const MaterialEntry &probeMaterial();
+
+    /**
+     * Fills the entry with the bishop pair imbalance, the scale factors of drawish material, and the evaluator
+     * of a known endgame.
+     */
+    static void computeMaterial(MaterialEntry &entry, uint64_t material_key);
+
+    /**
+     * Adds the pawn structure terms, from the pawn table when the pawns were seen before, and sets the
+     * pawn rearspans and attacks.
+     */
+    void evaluatePawns();
 
     void pawnStructure();
 
@@ -79,12 +100,6 @@ private:
     static void
     accumulateKingThreats(int &n_attackers, int32_t &mg_score, int32_t &eg_score, uint64_t attacks, uint64_t king);
 
-    void PSQTs();
-
-    void whitePSQT(uint64_t bb, const int32_t psqt[64], const int32_t eg_psqt[64]);
-
-    void blackPSQT(uint64_t bb, const int32_t psqt[64], const int32_t eg_psqt[64]);
-
     void whiteCharacteristic(int n, Evaluation::characteristic_t type);
 
     void blackCharacteristic(int n, Evaluation::characteristic_t type);
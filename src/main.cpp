@@ -1,16 +1,36 @@
 #include <iostream>
 
 #include "uci.h"
+#include "bench.h"
 #include "movegen.h"
+#include "perft.h"
 
 #define BUFLEN 512
 
 /**
  * To compile: 
- *  g++ src/*.cpp -lpthread -o juliette
+ *  g++ -std=c++14 src/*.cpp -lpthread -o juliette
  * 
  * To run:
  *  ./juliette cli
+ *
+ * To count the leaf nodes of the move tree of a position:
+ *  ./juliette perft <depth> [fen]
+ *  ./juliette divide <depth> [fen]
+ *
+ * To search a fixed set of positions and print the node count signature:
+ *  ./juliette bench [depth] [threads] [hashMB]
+ *
+ * To compare the speed of magic and PEXT sliding attack lookups, the faster of which is otherwise
+ * selected at startup from the CPU features:
+ *  ./juliette sliders [depth]
+ *
+ * To check the compiled magic numbers and search a fresh set of them:
+ *  ./juliette magics
+ *
+ * To stress test the transposition table shared by the search threads, and check the pseudo-legal
+ * move generator of the search against perft:
+ *  ./juliette test
  */
 
 enum CommunicationMode {
@@ -25,6 +45,30 @@ int main(int argc, char *argv[]) {
 
     MoveGen::initMoveGenData();
 
+    if (strcmp(argv[1], "perft") == 0 || strcmp(argv[1], "divide") == 0) {
+        std::vector<std::string> args(argv + 2, argv + argc);
+        Perft::parsePerftString(args, strcmp(argv[1], "divide") == 0);
+        return 0;
+    } else if (strcmp(argv[1], "bench") == 0) {
+        std::vector<std::string> args(argv + 2, argv + argc);
+        Bench::parseBenchString(args);
+        return 0;
+    } else if (strcmp(argv[1], "sliders") == 0) {
+        int depth = 4;
+        if (argc > 2 && (!StringUtils::isNumber(&depth, argv[2]) || depth < 1 || depth >= MAX_DEPTH - 1)) {
+            std::cout << "juliette:: syntax: sliders [depth]" << std::endl;
+            return 0;
+        }
+        Bench::compareSliderBackends(depth);
+        return 0;
+    } else if (strcmp(argv[1], "magics") == 0) {
+        return MoveGen::searchMagics() ? 0 : 1;
+    } else if (strcmp(argv[1], "test") == 0) {
+        bool passed = test_transposition_table();
+        passed = Perft::testPseudoLegal(4) && passed;
+        return passed ? 0 : 1;
+    }
+
     CommunicationMode mode = CommunicationMode::UNDEFINED;
     char recvbuf[BUFLEN];
     if (strcmp(argv[1], "cli") == 0) {
@@ -81,13 +125,13 @@ int main(int argc, char *argv[]) {
                io.parseUCIString("ucinewgame");
                io.parseUCIString("position startpos");
                io.parseUCIString("go movetime 2000");
-            } else if (strcmp(recvbuf, "perft") == 0) {
+            } else if (strncmp(recvbuf, "perft", 5) == 0 || strncmp(recvbuf, "divide", 6) == 0) {
                 std::cout << "juliette:: starting performance test..." << std::endl;
-                //
-                // To be used for performance test:
-                //
-
-                // [insert performance test code here]
+                std::string perftString(recvbuf);
+                std::vector<std::string> args = StringUtils::split(perftString);
+                const bool divide = args[0] == "divide";
+                args.erase(args.begin(), args.begin() + 1);
+                Perft::parsePerftString(args, divide);
             } else if (strlen(recvbuf)) {
                 std::cout << "Unrecognized command: " << recvbuf << '\n';
                 std::cout
@@ -1,6 +1,5 @@
 #include <iostream>
 
-#include "stack.h"
 #include "movegen.h"
 #include "bitboard.h"
 #include "search.h"
@@ -22,10 +21,6 @@ const uint64_t MoveGen::BB_KNIGHT_ATTACKS[64] = {
         0x44280000000000, 0x88500000000000, 0x10a00000000000, 0x20400000000000
 };
 
-uint64_t MoveGen::BB_BISHOP_ATTACKS[64][512];
-
-uint64_t MoveGen::BB_ROOK_ATTACKS[64][4096];
-
 const uint64_t MoveGen::BB_KING_ATTACKS[64] = {
         0x302, 0x705, 0xe0a, 0x1c14, 0x3828,
         0x7050, 0xe0a0, 0xc040, 0x30203, 0x70507,
@@ -76,158 +71,132 @@ const uint64_t MoveGen::ROOK_MAGICS[64] = {
         0x1000204080011, 0x1000204000801, 0x1000082000401, 0x1fffaabfad1a2
 };
 
-uint64_t MoveGen::BB_BISHOP_ATTACK_MASKS[64];
-uint64_t MoveGen::BB_ROOK_ATTACK_MASKS[64];
-uint64_t MoveGen::ROOK_ATTACK_SHIFTS[64];
-uint64_t MoveGen::BISHOP_ATTACK_SHIFTS[64];
-
-void MoveGen::initMoveGenData() {
-    MoveGen::init_bishop_attacks();
-    MoveGen::init_rook_attacks();
-    MoveGen::_init_rays();
-}
+// Bishop directions first, then rook directions, as {rank step, file step}
+static constexpr int SLIDER_DIRECTIONS[8][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}};
 
 /**
- * Initalizes the bishop attack magic bitboard
- * @author github.com/nkarve
+ * Empty board rays from every square in every slider direction, excluding the square itself.
  */
-void MoveGen::init_bishop_attacks() {
-    for (int square = Squares::A1; square <= Squares::H8; ++square) {
-        uint64_t edges = ((Bitboard::BB_RANK_1 | Bitboard::BB_RANK_8) & ~Bitboard::BB_RANKS[Bitboard::rankOf(square)]) |
-                         ((Bitboard::BB_FILE_A | Bitboard::BB_FILE_H) & ~Bitboard::BB_FILES[Bitboard::fileOf(square)]);
-        MoveGen::BB_BISHOP_ATTACK_MASKS[square] =
-                (Bitboard::BB_DIAGONALS[Bitboard::diagonalOf(square)] ^ Bitboard::BB_ANTI_DIAGONALS[Bitboard::antiDiagonalOf(square)]) & ~edges;
-        uint64_t attack_mask = MoveGen::BB_BISHOP_ATTACK_MASKS[square];
-
-        int shift = 64 - BitUtils::popCount(attack_mask);
-        MoveGen::BISHOP_ATTACK_SHIFTS[square] = shift;
+struct direction_rays_t {
+    uint64_t rays[8][64];
+};
 
-        uint64_t subset = 0;
-        do {
-            uint64_t index = subset;
-            index *= BISHOP_MAGICS[square];
-            index >>= shift;
-            MoveGen::BB_BISHOP_ATTACKS[square][index] = _init_bishop_attacks_helper(square, subset);
-            subset = (subset - attack_mask) & attack_mask;
-        } while (subset);
+static constexpr direction_rays_t generateDirectionRays() {
+    direction_rays_t table = {};
+    for (int i = 0; i < 8; ++i) {
+        const int dRank = SLIDER_DIRECTIONS[i][0], dFile = SLIDER_DIRECTIONS[i][1];
+        for (int square = Squares::A1; square <= Squares::H8; ++square) {
+            for (int rank = square / 8 + dRank, file = square % 8 + dFile; 0 <= rank && rank < 8 && 0 <= file && file < 8;
+                 rank += dRank, file += dFile) {
+                table.rays[i][square] |= 1ULL << (8 * rank + file);
+            }
+        }
     }
+    return table;
 }
 
+static constexpr direction_rays_t DIRECTION_RAYS = generateDirectionRays();
 
 /**
- * Initalizes the rook attack magic bitboard
- * @author github.com/nkarve
+ * Attacks of a slider with the given occupancy: each ray up to and including its first blocker, found
+ * by cutting off the ray of the same direction that starts at the blocker. Only used to build tables.
+ * @param square the square of the slider.
+ * @param occupied the occupied squares.
+ * @param rook whether the slider is a rook, else a bishop.
  */
-void MoveGen::init_rook_attacks() {
-    for (int square = Squares::A1; square <= Squares::H8; square++) {
-        uint64_t edges = ((Bitboard::BB_RANK_1 | Bitboard::BB_RANK_8) & ~Bitboard::BB_RANKS[Bitboard::rankOf(square)]) |
-                         ((Bitboard::BB_FILE_A | Bitboard::BB_FILE_H) & ~Bitboard::BB_FILES[Bitboard::fileOf(square)]);
-        MoveGen::BB_ROOK_ATTACK_MASKS[square] = (Bitboard::BB_RANKS[Bitboard::rankOf(square)] ^ Bitboard::BB_FILES[Bitboard::fileOf(square)]) & ~edges;
-        uint64_t attack_mask = MoveGen::BB_ROOK_ATTACK_MASKS[square];
+static constexpr uint64_t slidingAttacks(int square, uint64_t occupied, bool rook) {
+    uint64_t attacks = 0;
+    for (int i = 4 * rook; i < 4 * rook + 4; ++i) {
+        uint64_t ray = DIRECTION_RAYS.rays[i][square];
+        uint64_t blockers = ray & occupied;
+        if (blockers) {
+            /** Rays towards higher squares are cut at their lowest blocker, the others at their highest */
+            bool up = 8 * SLIDER_DIRECTIONS[i][0] + SLIDER_DIRECTIONS[i][1] > 0;
+            ray ^= DIRECTION_RAYS.rays[i][up ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers)];
+        }
+        attacks |= ray;
+    }
+    return attacks;
+}
 
-        int shift = 64 - BitUtils::popCount(attack_mask);
-        MoveGen::ROOK_ATTACK_SHIFTS[square] = shift;
+/**
+ * Builds the packed attack table of a slider. Only the occupancy of the relevant mask can change
+ * the attacks, since a blocker on the board edge hides nothing behind it. With PEXT the slice of a
+ * square is filled densely: the carry-rippler enumerates the subsets of a mask in increasing order,
+ * which is exactly the order of their PEXT indices, so a running counter serves as the index.
+ * @param rook whether the slider is a rook, else a bishop.
+ * @param pext whether to order the slices by PEXT index, else by magic index.
+ */
+template<std::size_t N>
+static constexpr slider_attacks_t<N> generateSliderAttacks(bool rook, bool pext) {
+    const uint64_t RANK_1 = 0xffULL, RANK_8 = RANK_1 << 56;
+    const uint64_t FILE_A = 0x0101010101010101ULL, FILE_H = FILE_A << 7;
 
-        uint64_t subset = 0;
+    slider_attacks_t<N> table = {};
+    uint32_t offset = 0;
+    for (int square = Squares::A1; square <= Squares::H8; ++square) {
+        uint64_t edges = ((RANK_1 | RANK_8) & ~(RANK_1 << (8 * (square / 8)))) | ((FILE_A | FILE_H) & ~(FILE_A << (square % 8)));
+        uint64_t attack_mask = slidingAttacks(square, 0, rook) & ~edges;
+        int shift = 64 - __builtin_popcountll(attack_mask);
+        table.masks[square] = attack_mask;
+        table.shifts[square] = shift;
+        table.offsets[square] = offset;
+
+        uint64_t subset = 0, count = 0;
         do {
-            uint64_t index = subset;
-            index *= MoveGen::ROOK_MAGICS[square];
-            index >>= shift;
-            MoveGen::BB_ROOK_ATTACKS[square][index] = _init_rook_attacks_helper(square, subset);
+            uint64_t magic = rook ? MoveGen::ROOK_MAGICS[square] : MoveGen::BISHOP_MAGICS[square];
+            uint64_t index = pext ? count++ : (subset * magic) >> shift;
+            table.attacks[offset + index] = slidingAttacks(square, subset, rook);
             subset = (subset - attack_mask) & attack_mask;
         } while (subset);
+        offset += 1U << (64 - shift);
     }
+    return table;
 }
 
-void MoveGen::_init_rays() {
-    for (int square1 = Squares::A1; square1 <= Squares::H8; square1++) {
-        for (int square2 = Squares::A1; square2 <= Squares::H8; square2++) {
-            if (square1 == square2) {
-                Bitboard::BB_RAYS[square1][square2] = 0ULL;
-                continue;
-            }
-
-            uint64_t square2_bb = Bitboard::BB_SQUARES[square2];
-
-            uint64_t rank = Bitboard::BB_RANKS[Bitboard::rankOf(square1)];
-            if (rank & square2_bb) {
-                Bitboard::BB_RAYS[square1][square2] = rank;
-                continue;
-            }
-
-            uint64_t file = Bitboard::BB_FILES[Bitboard::fileOf(square1)];
-            if (file & square2_bb) {
-                Bitboard::BB_RAYS[square1][square2] = file;
-                continue;
-            }
-
-            uint64_t diagonal = Bitboard::BB_DIAGONALS[Bitboard::diagonalOf(square1)];
-            if (diagonal & square2_bb) {
-                Bitboard::BB_RAYS[square1][square2] = diagonal;
-                continue;
-            }
-
-            uint64_t anti_diagonal = Bitboard::BB_ANTI_DIAGONALS[Bitboard::antiDiagonalOf(square1)];
-            if (anti_diagonal & square2_bb) {
-                Bitboard::BB_RAYS[square1][square2] = anti_diagonal;
-                continue;
+/**
+ * Builds the full lines through every pair of aligned squares. Two aligned squares see each other
+ * along their shared line on an empty board, and the rest of that line is what both see.
+ */
+static constexpr ray_table_t generateRays() {
+    ray_table_t table = {};
+    for (int square1 = Squares::A1; square1 <= Squares::H8; ++square1) {
+        for (int square2 = Squares::A1; square2 <= Squares::H8; ++square2) {
+            for (int rook = 0; rook < 2; ++rook) {
+                uint64_t attacks = slidingAttacks(square1, 0, rook);
+                if (attacks & (1ULL << square2)) {
+                    table.rays[square1][square2] = (attacks & slidingAttacks(square2, 0, rook)) | (1ULL << square1) | (1ULL << square2);
+                }
             }
-
-            Bitboard::BB_RAYS[square1][square2] = 0ULL;
         }
     }
+    return table;
 }
 
+constexpr slider_attacks_t<5248> MoveGen::BISHOP_ATTACKS = generateSliderAttacks<5248>(false, false);
+constexpr slider_attacks_t<102400> MoveGen::ROOK_ATTACKS = generateSliderAttacks<102400>(true, false);
+constexpr slider_attacks_t<5248> MoveGen::BISHOP_PEXT_ATTACKS = generateSliderAttacks<5248>(false, true);
+constexpr slider_attacks_t<102400> MoveGen::ROOK_PEXT_ATTACKS = generateSliderAttacks<102400>(true, true);
 
-/**
- * Helper method to initalizes the bishop attack magic bitboard
- * @param square the current square
- * @param subset the current occupancy
- * @param attack_mask the bishop's attack mask without edges
- * @return the bishop attack bitboard
- * @author github.com/nkarve
- */
-uint64_t MoveGen::_init_bishop_attacks_helper(int square, uint64_t subset) {
-    uint64_t square_mask = Bitboard::BB_SQUARES[square];
-    uint64_t diagonal_mask = Bitboard::BB_DIAGONALS[Bitboard::diagonalOf(square)];
-    uint64_t anti_diagonal_mask = Bitboard::BB_ANTI_DIAGONALS[Bitboard::antiDiagonalOf(square)];
-
-    uint64_t diagonal_attacks = (((diagonal_mask & subset) - square_mask * 2) ^
-                                 BitUtils::_get_reverse_bb(
-                                         BitUtils::_get_reverse_bb(diagonal_mask & subset) - BitUtils::_get_reverse_bb(square_mask) * 2)) &
-                                diagonal_mask;
-
-    uint64_t anti_diagonal_attacks = (((anti_diagonal_mask & subset) - square_mask * 2) ^
-                                      BitUtils::_get_reverse_bb(BitUtils::_get_reverse_bb(anti_diagonal_mask & subset) -
-                                                      BitUtils::_get_reverse_bb(square_mask) * 2)) &
-                                     anti_diagonal_mask;
-
-    return diagonal_attacks | anti_diagonal_attacks;
-}
+constexpr ray_table_t Bitboard::BB_RAYS = generateRays();
 
+bool MoveGen::PEXT_ENABLED = false;
 
-/**
- * Helper method to initalizes the rook attack magic bitboard
- * @param square the current square
- * @param subset the current occupancy
- * @param attack_mask the rook's attack mask without edges
- * @return the rook attack bitboard
- * @author github.com/nkarve
- */
-uint64_t MoveGen::_init_rook_attacks_helper(int square, uint64_t subset) {
-    uint64_t square_mask = Bitboard::BB_SQUARES[square];
-    uint64_t rank_mask = Bitboard::BB_RANKS[Bitboard::rankOf(square)];
-    uint64_t file_mask = Bitboard::BB_FILES[Bitboard::fileOf(square)];
-
-    uint64_t rank_attacks = (((rank_mask & subset) - square_mask * 2) ^
-                             BitUtils::_get_reverse_bb(BitUtils::_get_reverse_bb(rank_mask & subset) - BitUtils::_get_reverse_bb(square_mask) * 2)) &
-                            rank_mask;
+void MoveGen::initMoveGenData() {
+    MoveGen::selectSliderBackend(MoveGen::pextSupported());
+}
 
-    uint64_t file_attacks = (((file_mask & subset) - square_mask * 2) ^
-                             BitUtils::_get_reverse_bb(BitUtils::_get_reverse_bb(file_mask & subset) - BitUtils::_get_reverse_bb(square_mask) * 2)) &
-                            file_mask;
+bool MoveGen::pextSupported() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#else
+    return false;
+#endif
+}
 
-    return rank_attacks | file_attacks;
+void MoveGen::selectSliderBackend(bool pext) {
+    MoveGen::PEXT_ENABLED = pext && MoveGen::pextSupported();
 }
 
 
@@ -244,6 +213,70 @@ uint64_t BitUtils::_get_reverse_bb(uint64_t bb) {
     return (bb << 48) | ((bb & 0xffff0000) << 16) | ((bb >> 16) & 0xffff0000) | (bb >> 48);
 }
 
+bool MoveGen::isMagic(int square, bool rook, uint64_t magic) {
+    static uint64_t slots[4096];
+    static uint32_t slotEpochs[4096], epoch = 0;
+
+    const uint64_t attack_mask = rook ? MoveGen::ROOK_ATTACKS.masks[square] : MoveGen::BISHOP_ATTACKS.masks[square];
+    const int shift = rook ? MoveGen::ROOK_ATTACKS.shifts[square] : MoveGen::BISHOP_ATTACKS.shifts[square];
+
+    /** Slots written by an earlier candidate count as empty, so the scratch table is never cleared */
+    ++epoch;
+    uint64_t subset = 0;
+    do {
+        uint64_t index = (subset * magic) >> shift;
+        uint64_t attacks = slidingAttacks(square, subset, rook);
+        if (slotEpochs[index] != epoch) {
+            slotEpochs[index] = epoch;
+            slots[index] = attacks;
+        } else if (slots[index] != attacks) {
+            return false;
+        }
+        subset = (subset - attack_mask) & attack_mask;
+    } while (subset);
+    return true;
+}
+
+uint64_t MoveGen::findMagic(int square, bool rook, uint64_t &seed) {
+    const uint64_t attack_mask = rook ? MoveGen::ROOK_ATTACKS.masks[square] : MoveGen::BISHOP_ATTACKS.masks[square];
+    while (true) {
+        /** Magics with few set bits are far more likely to work */
+        uint64_t magic = BitUtils::splitmix64(seed) & BitUtils::splitmix64(seed) & BitUtils::splitmix64(seed);
+
+        /** Quick reject: the index bits must depend on enough of the mask */
+        if (BitUtils::popCount((attack_mask * magic) & 0xff00000000000000ULL) < 6) continue;
+        if (MoveGen::isMagic(square, rook, magic)) return magic;
+    }
+}
+
+bool MoveGen::searchMagics() {
+    bool valid = true;
+    for (int square = Squares::A1; square <= Squares::H8; ++square) {
+        if (!MoveGen::isMagic(square, false, MoveGen::BISHOP_MAGICS[square])) {
+            std::cout << "juliette:: bishop magic of square " << square << " is invalid\n";
+            valid = false;
+        }
+        if (!MoveGen::isMagic(square, true, MoveGen::ROOK_MAGICS[square])) {
+            std::cout << "juliette:: rook magic of square " << square << " is invalid\n";
+            valid = false;
+        }
+    }
+    std::cout << "juliette:: compiled magics are " << (valid ? "valid" : "INVALID") << ", tables take "
+              << (sizeof(MoveGen::BISHOP_ATTACKS.attacks) + sizeof(MoveGen::ROOK_ATTACKS.attacks)) / 1024 << " KB\n\n";
+
+    uint64_t seed = 0x6a756c6965747465ULL;
+    for (int rook = 0; rook < 2; ++rook) {
+        std::cout << "const uint64_t MoveGen::" << (rook ? "ROOK" : "BISHOP") << "_MAGICS[64] = {";
+        for (int square = Squares::A1; square <= Squares::H8; ++square) {
+            std::cout << (square % 5 ? " " : "\n        ") << "0x" << std::hex << MoveGen::findMagic(square, rook, seed) << std::dec
+                      << (square < Squares::H8 ? "," : "");
+        }
+        std::cout << "\n};\n\n";
+    }
+    std::cout << std::flush;
+    return valid;
+}
+
 /**
  * @param color
  * @return the bitboard of all the attacks the color's pawn can make,
@@ -1,8 +1,22 @@
 #ifndef MOVEGEN_H
 #define MOVEGEN_H
 
+#include <cstddef>
+
 #include "util.h"
 
+/**
+ * Attacks of one sliding piece type from every square, generated at compile time. Each square takes
+ * only the 2^n entries its n relevant occupancy bits need, packed one after another from its offset.
+ */
+template<std::size_t N>
+struct slider_attacks_t {
+    uint64_t masks[64];   // Relevant occupancy: the empty board attacks without the board edges
+    uint32_t shifts[64];  // 64 - n, to reduce a magic product to an n bit index
+    uint32_t offsets[64];
+    uint64_t attacks[N];
+};
+
 struct MoveGen 
 {
     friend struct Bitboard;
@@ -11,9 +25,14 @@ public:
 
     static const uint64_t BB_KNIGHT_ATTACKS[64];
 
-    static uint64_t BB_BISHOP_ATTACKS[64][512];
-
-    static uint64_t BB_ROOK_ATTACKS[64][4096];
+    /**
+     * Sliding attack tables, read only and built by the compiler. Both backends use the same slices;
+     * only the order of the entries within a slice differs, by magic index or by PEXT index.
+     */
+    static const slider_attacks_t<5248> BISHOP_ATTACKS;
+    static const slider_attacks_t<102400> ROOK_ATTACKS;
+    static const slider_attacks_t<5248> BISHOP_PEXT_ATTACKS;
+    static const slider_attacks_t<102400> ROOK_PEXT_ATTACKS;
 
     static const uint64_t BB_KING_ATTACKS[64];
 
@@ -21,8 +40,49 @@ public:
 
     static const uint64_t ROOK_MAGICS[64];
 
+    // Whether sliding attacks are looked up by PEXT index instead of by magic multiplication
+    static bool PEXT_ENABLED;
+
     static void initMoveGenData();
 
+    /**
+     * @return whether the CPU has a fast BMI2 PEXT instruction. Zen 1 and Zen 2 implement PEXT in
+     * microcode, many times slower than a magic multiplication, so they are reported as unsupported.
+     */
+    static bool pextSupported();
+
+    /**
+     * Switches the sliding attack lookups to the PEXT or the magic tables. Must not be called while a
+     * search is running.
+     * @param pext whether to use the PEXT tables. Ignored if the CPU does not support PEXT.
+     */
+    static void selectSliderBackend(bool pext);
+
+    /**
+     * @param square the square of the slider.
+     * @param rook whether the slider is a rook, else a bishop.
+     * @param magic the candidate magic number.
+     * @return whether the magic maps every relevant occupancy of the square into its 2^n entry slice
+     * without two occupancies with different attacks sharing a slot.
+     */
+    static bool isMagic(int square, bool rook, uint64_t magic);
+
+    /**
+     * Searches random sparse candidates until one is magic for the square.
+     * @param square the square of the slider.
+     * @param rook whether the slider is a rook, else a bishop.
+     * @param seed state of the random number generator, advanced by the search.
+     * @return the magic number found.
+     */
+    static uint64_t findMagic(int square, bool rook, uint64_t &seed);
+
+    /**
+     * Checks the compiled magic numbers, then searches a fresh set from a fixed seed and prints it in
+     * source form, ready to replace BISHOP_MAGICS and ROOK_MAGICS.
+     * @return whether every compiled magic number is valid.
+     */
+    static bool searchMagics();
+
     static uint64_t get_pawn_attacks_setwise(uint64_t, bool);
 
     static uint64_t get_knight_mask_setwise(uint64_t);
@@ -35,22 +95,6 @@ public:
 
 private:
 
-    // Attack masks and shifts for magic bitboard move generation
-    static uint64_t BB_BISHOP_ATTACK_MASKS[64];
-    static uint64_t BB_ROOK_ATTACK_MASKS[64];
-    static uint64_t ROOK_ATTACK_SHIFTS[64];
-    static uint64_t BISHOP_ATTACK_SHIFTS[64];
-
-    static void init_bishop_attacks();
-
-    static void init_rook_attacks();
-
-    static void _init_rays();
-
-    static uint64_t _init_bishop_attacks_helper(int, uint64_t);
-
-    static uint64_t _init_rook_attacks_helper(int, uint64_t);
-
     static uint64_t _get_ray_setwise_south(uint64_t, uint64_t);
 
     static uint64_t _get_ray_setwise_north(uint64_t, uint64_t);
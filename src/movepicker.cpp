@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "movepicker.h"
+#include "weights.h"
+
+MovePicker::MovePicker(Bitboard &board, move_t ttMove, const std::vector<move_t> &killers, const int32_t *historyTable)
+        : board(board), killers(killers), historyTable(historyTable) {
+    this->checkInfo = board.getCheckInfo();
+    this->stage = stage_t::TT_MOVE;
+    this->ttMove = ttMove;
+    this->nMoves = 0;
+    this->index = 0;
+    this->killerIndex = 0;
+    this->nBadCaptures = 0;
+    this->badIndex = 0;
+}
+
+scored_move_t MovePicker::pickBest() {
+    int best = this->index;
+    for (int i = this->index + 1; i < this->nMoves; ++i) {
+        if (this->scores[i] > this->scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(this->moves[this->index], this->moves[best]);
+    std::swap(this->scores[this->index], this->scores[best]);
+    scored_move_t picked = {this->moves[this->index], this->scores[this->index]};
+    ++this->index;
+    return picked;
+}
+
+bool MovePicker::isKiller(const move_t &mv) const {
+    return std::find(this->killers.begin(), this->killers.end(), mv) != this->killers.end();
+}
+
+scored_move_t &MovePicker::tagCheck(scored_move_t &mv) {
+    if (this->board.givesCheck(mv.move, this->checkInfo)) {
+        mv.setType(scored_move_t::type_t::CHECK_MOVE);
+    }
+    return mv;
+}
+
+scored_move_t MovePicker::nextMove() {
+    switch (this->stage) {
+        case stage_t::TT_MOVE:
+            this->stage = stage_t::GEN_CAPTURES;
+            if (!(this->ttMove == move_t::NULL_MOVE) && this->board.isMoveLegal(this->ttMove)) {
+                scored_move_t mv = {this->ttMove, 0};
+                mv.setScore(scored_move_t::type_t::HASH_MOVE, 0);
+                if (mv.move.flag < MoveFlags::EN_PASSANT) {
+                    mv.setType(scored_move_t::type_t::QUIET);
+                }
+                return this->tagCheck(mv);
+            }
+            /** Stale or colliding entry, so it can't match any generated move */
+            this->ttMove = move_t::NULL_MOVE;
+            // fall through
+        case stage_t::GEN_CAPTURES:
+            this->nMoves = this->board.genPseudoLegalNonquiescentMoves(this->moves);
+            this->index = 0;
+            for (int i = 0; i < this->nMoves; ++i) {
+                /** MVV-LVA, the most valuable victim first, ties broken by the least valuable attacker */
+                const move_t &mv = this->moves[i];
+                int32_t gain = mv.flag == MoveFlags::EN_PASSANT ? Weights::MATERIAL[piece_t::BLACK_PAWN] : this->board.pieceValue(mv.to);
+                if (mv.flag >= MoveFlags::PC_KNIGHT) {
+                    gain += Weights::MATERIAL[mv.flag - MoveFlags::PC_KNIGHT + piece_t::BLACK_KNIGHT];
+                } else if (mv.flag >= MoveFlags::PR_KNIGHT) {
+                    gain += Weights::MATERIAL[mv.flag - MoveFlags::PR_KNIGHT + piece_t::BLACK_KNIGHT];
+                }
+                this->scores[i] = 16 * gain - this->board.lookupMailbox(mv.from) % 6;
+            }
+            this->stage = stage_t::GOOD_CAPTURES;
+            // fall through
+        case stage_t::GOOD_CAPTURES:
+            while (this->index < this->nMoves) {
+                scored_move_t mv = this->pickBest();
+                if (mv.move == this->ttMove || !this->board.isLegal(mv.move)) continue;
+
+                /** Taking a more valuable piece wins material whatever the recapture, so SEE is only needed otherwise */
+                int32_t diff = this->board.pieceValue(mv.move.to) - this->board.pieceValue(mv.move.from);
+                if (!(mv.move.flag == MoveFlags::CAPTURE && diff > 0) && !this->board.see_ge(mv.move, 0)) {
+                    /** The exact loss is only worked out for the few captures that lose, to size their reduction */
+                    this->badCaptures[this->nBadCaptures] = mv.move;
+                    this->badScores[this->nBadCaptures++] = this->board.fastSEE(mv.move);
+                    continue;
+                }
+                int32_t mvvLva = mv.score;
+                mv.score = 0;
+                mv.setScore(scored_move_t::type_t::WINNING_EXCHANGE, mvvLva);
+                return this->tagCheck(mv);
+            }
+            this->stage = stage_t::KILLERS;
+            // fall through
+        case stage_t::KILLERS:
+            while (this->killerIndex < this->killers.size()) {
+                scored_move_t mv = {this->killers[this->killerIndex++], 0};
+                if (mv.move.flag >= MoveFlags::EN_PASSANT || mv.move == this->ttMove || !this->board.isMoveLegal(mv.move)) continue;
+                mv.setScore(scored_move_t::type_t::KILLER_MOVE, 0);
+                mv.setType(scored_move_t::type_t::QUIET);
+                return this->tagCheck(mv);
+            }
+            this->stage = stage_t::GEN_QUIETS;
+            // fall through
+        case stage_t::GEN_QUIETS: {
+            /** Captures are done with, so the quiet moves are compacted into the same arrays in place */
+            const int n = this->board.genPseudoLegalMoves(this->moves);
+            this->nMoves = 0;
+            this->index = 0;
+            for (int i = 0; i < n; ++i) {
+                const move_t mv = this->moves[i];
+                if (mv.flag >= MoveFlags::EN_PASSANT || mv == this->ttMove || this->isKiller(mv)) continue;
+                this->moves[this->nMoves] = mv;
+                this->scores[this->nMoves++] = this->historyTable[64 * this->board.lookupMailbox(mv.from) + mv.to];
+            }
+            this->stage = stage_t::QUIETS;
+        }
+        // fall through
+        case stage_t::QUIETS:
+            while (this->index < this->nMoves) {
+                scored_move_t mv = this->pickBest();
+                if (!this->board.isLegal(mv.move)) continue;
+                int32_t history = mv.score;
+                mv.score = 0;
+                if (!this->board.see_ge(mv.move, 0)) {
+                    /** Quiet move that loses material */
+                    mv.setScore(scored_move_t::type_t::LOSING_EXCHANGE, this->board.fastSEE(mv.move));
+                } else {
+                    mv.setScore(scored_move_t::type_t::QUIET, history);
+                }
+                return this->tagCheck(mv);
+            }
+            this->stage = stage_t::BAD_CAPTURES;
+            // fall through
+        case stage_t::BAD_CAPTURES:
+            if (this->badIndex < this->nBadCaptures) {
+                /** The capture that loses the least first */
+                int best = this->badIndex;
+                for (int i = this->badIndex + 1; i < this->nBadCaptures; ++i) {
+                    if (this->badScores[i] > this->badScores[best]) {
+                        best = i;
+                    }
+                }
+                std::swap(this->badCaptures[this->badIndex], this->badCaptures[best]);
+                std::swap(this->badScores[this->badIndex], this->badScores[best]);
+                scored_move_t mv = {this->badCaptures[this->badIndex], 0};
+                mv.setScore(scored_move_t::type_t::LOSING_EXCHANGE, this->badScores[this->badIndex++]);
+                return this->tagCheck(mv);
+            }
+            this->stage = stage_t::DONE;
+            // fall through
+        case stage_t::DONE:
+        default:
+            return {move_t::NULL_MOVE, 0};
+    }
+}
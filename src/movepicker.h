@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+#include "util.h"
+
+/**
+ * Yields the legal moves of a position one at a time, best first. Moves are generated and scored
+ * in stages, and a stage is only entered once the previous one runs dry, so a node that fails high
+ * on an early move never pays for generating or scoring the rest. Generated moves are pseudo-legal,
+ * and each is only tested for legality once it is picked.
+ *
+ * Stages:
+ * 1. The transposition table move, validated without generating any moves
+ * 2. Captures and promotions that do not lose material, by MVV-LVA
+ * 3. Killer moves, validated without generating any moves
+ * 4. Quiet moves, by history score
+ * 5. Captures that lose material, by SEE
+ */
+struct MovePicker {
+
+    /**
+     * @param board the position to pick moves in. Must not change while the picker is in use.
+     * @param ttMove the best move stored in the transposition table, or move_t::NULL_MOVE.
+     * @param killers the quiet moves that caused cutoffs at this ply.
+     * @param historyTable the history scores of quiet moves, indexed by piece and destination.
+     */
+    MovePicker(Bitboard &board, move_t ttMove, const std::vector<move_t> &killers, const int32_t *historyTable);
+
+    /**
+     * @return the next best move, tagged with its scored_move_t::type_t, or move_t::NULL_MOVE once
+     * every legal move has been returned.
+     */
+    scored_move_t nextMove();
+
+private:
+
+    enum stage_t {
+        TT_MOVE, GEN_CAPTURES, GOOD_CAPTURES, KILLERS, GEN_QUIETS, QUIETS, BAD_CAPTURES, DONE
+    };
+
+    Bitboard &board;
+    checkinfo_t checkInfo;
+
+    const std::vector<move_t> &killers;
+    const int32_t *historyTable;
+
+    stage_t stage;
+    move_t ttMove;
+
+    // Moves of the current stage, and their ordering scores in a parallel array
+    move_t moves[Bitboard::MAX_MOVE_NUM];
+    int32_t scores[Bitboard::MAX_MOVE_NUM];
+    int nMoves, index;
+    size_t killerIndex;
+
+    // Captures that lose material, and their SEE values
+    move_t badCaptures[Bitboard::MAX_MOVE_NUM];
+    int32_t badScores[Bitboard::MAX_MOVE_NUM];
+    int nBadCaptures, badIndex;
+
+    /**
+     * Moves the highest scoring remaining move of the current stage to the front and returns it.
+     */
+    scored_move_t pickBest();
+
+    bool isKiller(const move_t &) const;
+
+    /**
+     * Tags the move as giving check, if it does.
+     */
+    scored_move_t &tagCheck(scored_move_t &);
+};
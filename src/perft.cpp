@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "bench.h"
+#include "bitboard.h"
+#include "perft.h"
+#include "util.h"
+
+uint64_t Perft::perft(Bitboard &board, int depth) {
+    if (depth <= 0) {
+        return 1ULL;
+    }
+
+    move_t moves[Bitboard::MAX_MOVE_NUM];
+    int n = board.genLegalMoves(moves, board.getTurn());
+    /** Bulk counting, the leaves themselves are never made. */
+    if (depth == 1) {
+        return (uint64_t) n;
+    }
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < n; ++i) {
+        const undo_t undo = board.makeMove(moves[i]);
+        nodes += Perft::perft(board, depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+uint64_t Perft::perftPseudoLegal(Bitboard &board, int depth) {
+    if (depth <= 0) {
+        return 1ULL;
+    }
+
+    move_t moves[Bitboard::MAX_MOVE_NUM];
+    int n = board.genPseudoLegalMoves(moves);
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!board.isLegal(moves[i])) continue;
+        if (depth == 1) {
+            ++nodes;
+            continue;
+        }
+        const undo_t undo = board.makeMove(moves[i]);
+        nodes += Perft::perftPseudoLegal(board, depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+uint64_t Perft::run(const std::string &fen, int depth, size_t nThreads, bool divide) {
+    PerftJob job;
+    job.root = Bitboard(fen);
+    job.depth = depth;
+    job.nextMove = 0;
+    pthread_mutex_init(&job.lock, nullptr);
+
+    move_t moves[Bitboard::MAX_MOVE_NUM];
+    int n = job.root.genLegalMoves(moves, job.root.getTurn());
+    job.rootMoves.assign(moves, moves + n);
+    job.rootCounts.assign(n, 0ULL);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    if (depth <= 1) {
+        nodes = Perft::perft(job.root, depth);
+        std::fill(job.rootCounts.begin(), job.rootCounts.end(), 1ULL);
+    } else {
+        nThreads = std::max((size_t) 1, std::min(nThreads, (size_t) n));
+        std::vector<pthread_t> workers(nThreads);
+        for (size_t i = 0; i < nThreads; ++i) {
+            if (pthread_create(&(workers[i]), nullptr, perftThreadFunction, (void *) &job)) {
+                std::cout << "juliette:: Failed to spawn thread!\n";
+                exit(-1);
+            }
+        }
+        for (size_t i = 0; i < nThreads; ++i) {
+            pthread_join(workers[i], nullptr);
+        }
+        for (int i = 0; i < n; ++i) {
+            nodes += job.rootCounts[i];
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    pthread_mutex_destroy(&job.lock);
+
+    if (divide) {
+        for (int i = 0; i < n; ++i) {
+            std::cout << job.rootMoves[i].to_string() << ": " << job.rootCounts[i] << '\n';
+        }
+        std::cout << '\n';
+    }
+
+    long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    long long nps = (long long) (1000 * nodes / std::max(elapsed, 1LL));
+    std::cout << "Nodes searched: " << nodes << '\n';
+    std::cout << "Elapsed time:   " << elapsed << " ms\n";
+    std::cout << "Nodes/second:   " << nps << std::endl;
+    return nodes;
+}
+
+void Perft::parsePerftString(const std::vector<std::string> &args, bool divide) {
+    int depth;
+    if (args.empty() || !StringUtils::isNumber(&depth, args[0]) || depth < 1) {
+        std::cout << "juliette:: syntax: " << (divide ? "divide" : "perft") << " <depth> [fen]" << std::endl;
+        return;
+    }
+
+    std::string fen;
+    if (args.size() == 1 || args[1] == "startpos") {
+        fen = START_POSITION;
+    } else {
+        /** Recombine FEN that was split apart earlier */
+        for (size_t i = 1; i < args.size(); ++i) {
+            fen += args[i];
+            fen += ' ';
+        }
+    }
+
+    size_t nThreads = std::max(1U, std::thread::hardware_concurrency());
+    Perft::run(fen, depth, nThreads, divide);
+}
+
+bool Perft::testPseudoLegal(int depth) {
+    int nFailed = 0;
+    for (const std::string &fen : Bench::POSITIONS) {
+        Bitboard board(fen);
+        uint64_t legal = Perft::perft(board, depth);
+        uint64_t pseudoLegal = Perft::perftPseudoLegal(board, depth);
+        if (legal != pseudoLegal) {
+            std::cout << "juliette:: pseudo-legal perft " << depth << " gives " << pseudoLegal << " instead of " << legal
+                      << " on " << fen << '\n';
+            ++nFailed;
+        }
+    }
+    std::cout << "juliette:: pseudo-legal perft test: " << Bench::POSITIONS.size() - nFailed << '/' << Bench::POSITIONS.size()
+              << " positions agree" << std::endl;
+    return nFailed == 0;
+}
+
+void *perftThreadFunction(void *arg) {
+    PerftJob *job = reinterpret_cast<PerftJob *> (arg);
+    Bitboard board = job->root;
+    const size_t n = job->rootMoves.size();
+    while (true) {
+        pthread_mutex_lock(&job->lock);
+        size_t i = job->nextMove++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= n) break;
+
+        const undo_t undo = board.makeMove(job->rootMoves[i]);
+        job->rootCounts[i] = Perft::perft(board, job->depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nullptr;
+}
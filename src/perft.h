@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "bitboard.h"
+#include "util.h"
+
+/**
+ * Shared state of a single perft run. Root moves are handed out to the worker
+ * pool one at a time, and each worker writes the leaf count of the subtree it
+ * expanded into the slot of that root move.
+ */
+struct PerftJob {
+    Bitboard root;
+
+    std::vector<move_t> rootMoves;
+    std::vector<uint64_t> rootCounts;
+
+    int depth;
+    size_t nextMove;
+
+    pthread_mutex_t lock;
+};
+
+struct Perft {
+
+    /**
+     * Counts the leaf nodes of the legal move tree of the given depth. Leaves are
+     * bulk counted: at depth 1 the number of generated moves is returned directly.
+     * @param board the position to expand. Restored before returning.
+     * @param depth the number of plies to expand.
+     * @return the number of leaf nodes.
+     */
+    static uint64_t perft(Bitboard &board, int depth);
+
+    /**
+     * Counts the leaf nodes like perft, but through the pseudo-legal generator and isLegal as used
+     * by the search, so it must always agree with perft.
+     * @param board the position to expand. Restored before returning.
+     * @param depth the number of plies to expand.
+     * @return the number of leaf nodes.
+     */
+    static uint64_t perftPseudoLegal(Bitboard &board, int depth);
+
+    /**
+     * Splits the root moves of the position across a pool of worker threads.
+     * @param fen the position to expand.
+     * @param depth the number of plies to expand.
+     * @param nThreads the number of worker threads.
+     * @param divide whether to print the leaf count of every root move.
+     * @return the number of leaf nodes.
+     */
+    static uint64_t run(const std::string &fen, int depth, size_t nThreads, bool divide);
+
+    /**
+     * Parses "perft <depth> [fen]" or "divide <depth> [fen]" arguments and runs the test.
+     * @param args the arguments following the command name.
+     * @param divide whether to print the leaf count of every root move.
+     */
+    static void parsePerftString(const std::vector<std::string> &args, bool divide);
+
+    /**
+     * Cross-validates perftPseudoLegal against perft on the bench positions.
+     * @param depth the number of plies to expand each position.
+     * @return whether the leaf counts agreed on every position.
+     */
+    static bool testPseudoLegal(int depth);
+};
+
+void *perftThreadFunction(void *);
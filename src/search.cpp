@@ -3,21 +3,21 @@
 #include <pthread.h>
 #include <algorithm>
 #include <random>
-#include <unordered_map>
 
 #include "bitboard.h"
 #include "evaluation.h"
 #include "movegen.h"
+#include "movepicker.h"
 #include "search.h"
-#include "stack.h"
 #include "tables.h"
 #include "timeman.h"
 #include "uci.h"
 #include "util.h"
 #include "weights.h"
 
-#define MIN_SCORE (INT32_MIN + 1000)
-#define MATE_SCORE(depth) (MIN_SCORE + INT16_MAX + depth)
+/** Scores fit in 16 bits, as the transposition table stores them, with mate scores below any evaluation */
+#define MIN_SCORE (INT16_MIN + 1000)
+#define MATE_SCORE(depth) (MIN_SCORE + MAX_DEPTH + depth)
 
 
 pthread_mutex_t SearchContext::init_lock;
@@ -34,21 +34,23 @@ volatile size_t SearchContext::nActiveThreads = 0;
 volatile bool SearchContext::timeRemaining = false;
 bool SearchContext::blockHelpers = false;
 
+int16_t SearchContext::depthLimit = MAX_DEPTH - 2;
+bool SearchContext::deterministic = false;
+
 /**
- * Verifies three-fold repetition claimed by the repetition table.
- * @param hash Hash-code of the position to check
- * @return whether the three-fold repetition of the position provided by the hash-code is valid.
+ * Scans the move history for earlier occurrences of the current position. Only positions since the
+ * last capture or pawn move can recur, and only every other one has the same side to move.
+ * @return whether the current position has occurred at least three times before.
  */
 
-bool SearchContext::verifyRepetition(uint64_t hash) {
+bool SearchContext::isRepetition() {
+    const uint64_t hash = this->board.getHashCode();
+    const int n = (int) this->history.size();
+    const int earliest = std::max(0, n - this->board.getHalfmoveClock());
     int numSeen = 0;
-    LinkedStack *iterator = this->stack;
-    while (iterator) {
-        if (iterator->board.getHashCode() == hash) {
-            numSeen += int(iterator->board == this->board);
-            if (numSeen >= 3) return true;
-        }
-        iterator = iterator->next;
+    for (int i = n - 2; i >= earliest; i -= 2) {
+        numSeen += int(this->history[i].hash_code == hash);
+        if (numSeen >= 3) return true;
     }
     return false;
 }
@@ -60,14 +62,7 @@ bool SearchContext::verifyRepetition(uint64_t hash) {
  */
 
 bool SearchContext::isDrawn() {
-    const std::unordered_map<uint64_t, RTEntry>::const_iterator iterator = this->repetitionTable.find(this->board.getHashCode());
-    if (iterator != repetitionTable.end()) {
-        const RTEntry &rt_entry = iterator->second;
-        if (rt_entry.num_seen >= 3) {
-            return this->verifyRepetition(this->board.getHashCode());
-        }
-    }
-    return this->board.getHalfmoveClock() >= 100;
+    return this->board.getHalfmoveClock() >= 100 || this->isRepetition();
 }
 
 /**
@@ -77,8 +72,8 @@ bool SearchContext::isDrawn() {
  * @return Returns whether depth == 1, candidate move is not a check, and previous move was not a check (we are moving out of check)
  */
 
-bool SearchContext::useFutilityPruning(move_t cm, int16_t depth) {
-    return depth == 1 && !cm.isType(move_t::type_t::CHECK_MOVE) && !this->stack->previousMove.isType(move_t::type_t::CHECK_MOVE);
+bool SearchContext::useFutilityPruning(scored_move_t cm, int16_t depth) {
+    return depth == 1 && !cm.isType(scored_move_t::type_t::CHECK_MOVE) && !this->board.isInCheck(this->board.getTurn());
 }
 
 /**
@@ -96,6 +91,22 @@ const info_t &SearchContext::getResult() {
     return SearchContext::result;
 }
 
+/**
+ * Extends moves that give check by one ply, as the reply is forced and cheap to search. Checks that lose
+ * material are not extended, and neither is any move once the line is close to MAX_DEPTH.
+ * @param mv Move to compute the extension for.
+ * @param currentPly Current ply remaining to search.
+ * @return The amount by which to extend current ply.
+ */
+
+int16_t SearchContext::computeExtension(scored_move_t mv, int16_t currentPly) {
+    if (mv.isType(scored_move_t::type_t::CHECK_MOVE) && !mv.isType(scored_move_t::type_t::LOSING_EXCHANGE) &&
+        this->ply + currentPly < MAX_DEPTH - 2) {
+        return 1;
+    }
+    return 0;
+}
+
 /**
  * Implements Late Move Reduction.
  * @param move Move to determine compute reduction ply count.
@@ -104,24 +115,23 @@ const info_t &SearchContext::getResult() {
  * @return The amount by which to reduce current ply.
  */
 
-int16_t SearchContext::computeReduction(move_t mv, int16_t currentPly, int i) {
+int16_t SearchContext::computeReduction(scored_move_t mv, int16_t currentPly, int i) {
     const int16_t noReduction = 3;
     const int NO_LMR = 4;
-    /** If there are two plies or fewer to horizon, giving check, or in check, do not reduce. */
-    if (currentPly < noReduction || i < NO_LMR ||
-        mv.isType(move_t::type_t::CHECK_MOVE) || this->stack->previousMove.isType(move_t::type_t::CHECK_MOVE)) {
+    /** If there are two plies or fewer to horizon, or giving check, do not reduce. */
+    if (currentPly < noReduction || i < NO_LMR || mv.isType(scored_move_t::type_t::CHECK_MOVE)) {
         return 0;
     }
 
     /** If move is a capture or promotion (tactical possibilities), do not reduce. */
-    if (mv.flag >= MoveFlags::EN_PASSANT && !mv.isType(move_t::type_t::LOSING_EXCHANGE)) {
+    if (mv.move.flag >= MoveFlags::EN_PASSANT && !mv.isType(scored_move_t::type_t::LOSING_EXCHANGE)) {
         return 0;
     }
 
     /** int32_t material_loss_rf: Material loss in centi-pawns resulting in one additional ply reduction */
     const int32_t materialLossRf = 250;
     int16_t reduction = 1 + int16_t(sqrt(currentPly - 1) + sqrt(i - 1));
-    if (mv.isType(move_t::LOSING_EXCHANGE)) {
+    if (mv.isType(scored_move_t::LOSING_EXCHANGE)) {
         const int32_t loss = -mv.normalizeScore();
         const int16_t inc = (loss - 1) / materialLossRf + 1;
         reduction += inc;
@@ -167,103 +177,68 @@ int32_t SearchContext::moveValue(move_t move) {
     }
 }
 
-void SearchContext::storeCutoffMove(move_t mv, int16_t depth) {
-    if (mv.isType(move_t::type_t::QUIET)) {
-        if (!mv.isType(move_t::type_t::KILLER_MOVE)) {
-            this->killerMoves[ply].push_back(mv);
+void SearchContext::storeCutoffMove(scored_move_t mv, int16_t depth) {
+    if (mv.isType(scored_move_t::type_t::QUIET)) {
+        std::vector<move_t> &kmvs = this->killerMoves[ply];
+        if (std::find(kmvs.begin(), kmvs.end(), mv.move) == kmvs.end()) {
+            /** Most recent first, every killer is validated before it is searched */
+            if (kmvs.size() == SearchContext::MAX_KILLERS) kmvs.pop_back();
+            kmvs.insert(kmvs.begin(), mv.move);
         }
-        this->historyTable[hTableIndex(mv)] += depth * depth;
+        this->historyTable[hTableIndex(mv.move)] += depth * depth;
     }
 }
 
-void SearchContext::orderMoves(move_t mvs[], int n) {
-    const TTEntry *it = SearchContext::transpositionTable.find(board.getHashCode());
-    const std::vector<move_t> &kmvs = killerMoves[ply];
-
-    move_t hash_move = move_t::NULL_MOVE;
-    if (it) {
-        hash_move = it->bestMove;
-    }
+void SearchContext::pushMove(const move_t &mv) {
+    this->history.push_back(this->board.makeMove(mv));
+    ++(this->nodes);
+    ++(this->ply);
+}
 
-    for (int i = 0; i < n; ++i) {
-        move_t &mv = mvs[i];
-        if (mv == hash_move) {
-            mv.setScore(move_t::type_t::HASH_MOVE, 0);
-            continue;
-        } else if (std::find(kmvs.begin(), kmvs.end(), mv) != kmvs.end()) {
-            mv.setScore(move_t::type_t::KILLER_MOVE, 0);
-            continue;
-        }
+void SearchContext::popMove() {
+    this->board.unmakeMove(this->history.back());
+    this->history.pop_back();
+    --(this->ply);
+}
 
-        if (board.isMoveCheck(mv)) {
-            mv.setScore(move_t::type_t::CHECK_MOVE, 0);
-        }
+/**
+ * Counts an event of the calling thread. Only the owning thread writes the counter, so a relaxed load and
+ * store suffice, and the search pays for no atomic read-modify-write.
+ */
+static inline void countEvent(std::atomic<uint64_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
 
-        switch (mv.flag) {
-            case CASTLING: {
-                mv.setScore(move_t::type_t::QUIET, this->historyTable[this->hTableIndex(mv)]);
-                break;
-            }
-            case CAPTURE: {
-                int diff = this->board.pieceValue(mv.to) - this->board.pieceValue(mv.from);
-                if (diff > 0) {
-                    mv.setScore(move_t::type_t::WINNING_EXCHANGE, diff);
-                    break;
-                }
-            }
-            default: {
-                /** fastSEE determines whether or not the move wins or loses material */
-                int32_t see_score = this->board.fastSEE(mv);
-                if (see_score < 0) {
-                    /** Quiet move that loses material, or losing exchange. */
-                    mv.setScore(move_t::type_t::LOSING_EXCHANGE, see_score);
-                } else if (mv.flag == NONE) {
-                    /** Quiet move. Cannot be a move that wins material since that would require capture. */
-                    mv.setScore(move_t::type_t::QUIET, this->historyTable[this->hTableIndex(mv)]);
-                } else {
-                    /** Non-quiet move that wins, or maintains equal material */
-                    mv.setScore(move_t::type_t::WINNING_EXCHANGE, see_score);
-                }
-            }
-        }
+int32_t SearchContext::staticEval() {
+    const uint64_t hash_code = this->board.getHashCode();
+    int32_t eval;
+    countEvent(this->evalProbes);
+    if (this->evalCache.find(hash_code, eval)) {
+        countEvent(this->evalCacheHits);
+        return eval;
     }
-    std::sort(mvs, mvs + n);
-}
 
-void SearchContext::pushMove(const move_t &mv) {
-    LinkedStack *node = new LinkedStack(this->board, mv);
-    node->next = this->stack;
-    this->stack = node;
-    this->board.makeMove(mv);
-    std::unordered_map<uint64_t, RTEntry>::iterator rtPair = repetitionTable.find(this->board.getHashCode());
-    if (rtPair != repetitionTable.end()) {
-        RTEntry &rtEntry = rtPair->second;
-        ++rtEntry.num_seen;
+    TTEntry t;
+    if (SearchContext::transpositionTable.find(hash_code, t) && t.staticEval != TTEntry::NO_EVAL) {
+        countEvent(this->ttEvalHits);
+        eval = t.staticEval;
     } else {
-        this->repetitionTable.insert(std::pair<uint64_t, RTEntry>(this->board.getHashCode(), RTEntry(1)));
+        eval = this->position.evaluate();
     }
-    ++(this->ply);
-}
-
-void SearchContext::popMove() {
-    RTEntry &rtPair = this->repetitionTable.find(this->board.getHashCode())->second;
-    --rtPair.num_seen;
-    LinkedStack *head = this->stack;
-    this->board = head->board;
-    this->stack = head->next;
-    --(this->ply);
-    delete head;
+    this->evalCache.insert(hash_code, eval);
+    return eval;
 }
 
 /**
  * @brief Extends the search_fd position until a "quiet" position is reached.
  * @param alpha: Minimum score that the maximizing player is assured of.
  * @param beta: Maximum score that the minimizing player is assured of.
+ * @param checks: Whether to also search quiet moves that give check, only set on the first ply.
  * @return The static evaluation 
  */
 
-int32_t SearchContext::qsearch(int32_t alpha, int32_t beta) { // NOLINT
-    int32_t stand_pat;
+int32_t SearchContext::qsearch(int32_t alpha, int32_t beta, bool checks) { // NOLINT
+    int32_t stand_pat = 0;
 
     int n;
     move_t moves[Bitboard::MAX_MOVE_NUM];
@@ -271,10 +246,21 @@ int32_t SearchContext::qsearch(int32_t alpha, int32_t beta) { // NOLINT
     bool in_check = false;
     if (!board.isInCheck(board.getTurn())) {
         /** Generate non-quiet moves, such as promotions, and captures. */
-        n = this->board.genNonquiescentMoves(moves, this->board.getTurn()); // TODO Refactor movegen
+        n = this->board.genPseudoLegalNonquiescentMoves(moves);
+        if (checks) {
+            /** Quiet checks can only be found by generating all moves, but the check test itself is cheap */
+            move_t quiets[Bitboard::MAX_MOVE_NUM];
+            const checkinfo_t ci = this->board.getCheckInfo();
+            const int nQuiets = this->board.genPseudoLegalMoves(quiets);
+            for (int i = 0; i < nQuiets; ++i) {
+                if (quiets[i].flag < MoveFlags::EN_PASSANT && this->board.givesCheck(quiets[i], ci)) {
+                    moves[n++] = quiets[i];
+                }
+            }
+        }
         if (n == 0) {
             /** Position is quiet, return score. */
-            return position.evaluate();
+            return this->staticEval();
         }
     } else if ((n = this->board.genLegalMoves(moves, this->board.getTurn()))) { // TODO Refactor movegen
         /** Side to move is in check, evasions exist. */
@@ -287,7 +273,7 @@ int32_t SearchContext::qsearch(int32_t alpha, int32_t beta) { // NOLINT
 
     /** Block: Only runs if not in check, and non-quiet moves exist. */
 
-    stand_pat = position.evaluate();
+    stand_pat = this->staticEval();
     if (stand_pat >= beta) {
         return beta;
     }
@@ -310,15 +296,21 @@ int32_t SearchContext::qsearch(int32_t alpha, int32_t beta) { // NOLINT
     /** End block */
 
     CHECK_EVASIONS:
-    for (size_t i = 0; i < n; ++i) {
+    for (int i = 0; i < n; ++i) {
         const move_t &candidate_move = moves[i];
-        /** Delta pruning */
-        if (!in_check && moveValue(candidate_move) + stand_pat < alpha - Weights::DELTA_MARGIN) {
+        /** Delta pruning, quiet checks are searched for the threat and not the material */
+        if (!in_check && candidate_move.flag >= MoveFlags::EN_PASSANT &&
+            moveValue(candidate_move) + stand_pat < alpha - Weights::DELTA_MARGIN) {
             /** Skip evaluating this move */
             continue;
         }
 
-        if (this->board.fastSEE(candidate_move) < 0) {
+        /** Evasions are generated strictly legal, to tell checkmate apart, the rest only pseudo-legal */
+        if (!in_check && !this->board.isLegal(candidate_move)) {
+            continue;
+        }
+
+        if (!this->board.see_ge(candidate_move, 0)) {
             continue;
         }
 
@@ -349,38 +341,39 @@ int32_t SearchContext::pvs(int16_t depth, int32_t alpha, int32_t beta, move_t *m
         return 0;
     }
 
-    TTEntry *t = SearchContext::transpositionTable.find(this->board.getHashCode());
-    if (t != nullptr && t->depth >= depth) {
-        switch (t->flag) {
+    TTEntry t;
+    const bool ttHit = SearchContext::transpositionTable.find(this->board.getHashCode(), t);
+    if (ttHit && t.depth >= depth) {
+        switch (t.flag) {
             case BoundType::EXACT:
-                *moveHistory = t->bestMove;
-                return t->score;
+                *moveHistory = t.bestMove;
+                return t.score;
             case BoundType::LOWER:
-                alpha = std::max(alpha, t->score);
+                alpha = std::max(alpha, t.score);
                 break;
             case BoundType::UPPER:
-                beta = std::min(beta, t->score);
+                beta = std::min(beta, t.score);
                 break;
         }
 
         if (alpha >= beta) {
-            *moveHistory = t->bestMove;
-            return t->score;
+            *moveHistory = t.bestMove;
+            return t.score;
         }
     }
 
     const int32_t originalAlpha = alpha;
     if (depth <= 0) {
         // Extend the search_fd until the position is quiet
-        return this->qsearch(alpha, beta);
+        return this->qsearch(alpha, beta, true);
     }
 
-    // Move generation logic
-    move_t mvs[Bitboard::MAX_MOVE_NUM];
-    int n = this->board.genLegalMoves(mvs, this->board.getTurn());
+    // Moves are generated and ordered lazily, in stages
+    MovePicker picker(this->board, ttHit ? t.bestMove : move_t::NULL_MOVE, this->killerMoves[ply], this->historyTable);
+    scored_move_t mv = picker.nextMove();
 
     // Check lookahead terminating conditions
-    if (n == 0) {
+    if (mv.move == move_t::NULL_MOVE) {
         if (this->board.isInCheck(this->board.getTurn())) {
             // King is in check, and there are no legal moves. Checkmate!
             return MATE_SCORE(ply);
@@ -392,16 +385,13 @@ int32_t SearchContext::pvs(int16_t depth, int32_t alpha, int32_t beta, move_t *m
         return 0;
     }
 
-    // Move ordering logic
-    this->orderMoves(mvs, n);
-
     // Begin PVS check first move
-    size_t pvIndex = 0;
+    move_t bestMove = mv.move;
     move_t variations[depth + 1];
 
-    this->pushMove(mvs[0]);
-    variations[0] = mvs[0];
-    int32_t mvScore = -pvs(depth - 1, -beta, -alpha, &variations[1]);
+    this->pushMove(mv.move);
+    variations[0] = mv.move;
+    int32_t mvScore = -pvs(depth - 1 + this->computeExtension(mv, depth), -beta, -alpha, &variations[1]);
     this->popMove();
 
     if (mvScore > alpha) {
@@ -410,33 +400,33 @@ int32_t SearchContext::pvs(int16_t depth, int32_t alpha, int32_t beta, move_t *m
     }
 
     if (alpha >= beta) {
-        storeCutoffMove(mvs[0], depth);
+        storeCutoffMove(mv, depth);
         goto END;
     }
     // End PVS check first move
 
     // PVS check subsequent moves
-    for (size_t i = 1; i < n; ++i) {
-        const move_t &mv = mvs[i];
+    for (int i = 1; !((mv = picker.nextMove()).move == move_t::NULL_MOVE); ++i) {
         // Futility pruning
-        if (this->useFutilityPruning(mv, depth) && mvScore + this->moveValue(mv) < alpha - Weights::DELTA_MARGIN) {
+        if (this->useFutilityPruning(mv, depth) && mvScore + this->moveValue(mv.move) < alpha - Weights::DELTA_MARGIN) {
             continue;
         }
-        this->pushMove(mv);
-        variations[0] = mv;
+        this->pushMove(mv.move);
+        variations[0] = mv.move;
 
+        int16_t e = this->computeExtension(mv, depth);
         int16_t r = this->computeReduction(mv, depth, i);
         // Zero-Window Search. Assume good move ordering, and all subsequent mvs are worse.
-        mvScore = -1 * this->pvs(depth - 1 - r, -alpha - 1, -alpha, &variations[1]);
+        mvScore = -1 * this->pvs(depth - 1 + e - r, -alpha - 1, -alpha, &variations[1]);
         // If mvs[i] turns out to be better, re-search move with full window
         if (alpha < mvScore && mvScore < beta) {
-            mvScore = -1 * this->pvs(depth - 1, -beta, -alpha, &variations[1]);
+            mvScore = -1 * this->pvs(depth - 1 + e, -beta, -alpha, &variations[1]);
         }
         this->popMove();
 
         if (mvScore > alpha) {
             alpha = mvScore;
-            pvIndex = i;
+            bestMove = mv.move;
             std::memcpy(moveHistory, variations, depth * sizeof(move_t));
         }
 
@@ -447,8 +437,12 @@ int32_t SearchContext::pvs(int16_t depth, int32_t alpha, int32_t beta, move_t *m
         }
     }
     END:
-    /** Updates the transposition table with the appropriate values */
-    TTEntry ttEntry(this->board.getHashCode(), alpha, depth, BoundType::EXACT, mvs[pvIndex]);
+    /** Updates the transposition table with the appropriate values and the static evaluation */
+    int32_t eval = this->staticEval();
+    if (eval <= INT16_MIN || eval > INT16_MAX) {
+        eval = TTEntry::NO_EVAL;
+    }
+    TTEntry ttEntry(this->board.getHashCode(), alpha, depth, BoundType::EXACT, bestMove, (int16_t) eval);
     if (alpha <= originalAlpha) {
         ttEntry.flag = BoundType::UPPER;
     } else if (alpha >= beta) {
@@ -461,10 +455,16 @@ int32_t SearchContext::pvs(int16_t depth, int32_t alpha, int32_t beta, move_t *m
 }
 
 void SearchContext::search_t() {
+    /** Room for the deepest line up front, so that pushMove never allocates during the search */
+    this->history.reserve(this->history.size() + MAX_DEPTH);
+    this->evalProbes = 0;
+    this->evalCacheHits = 0;
+    this->ttEvalHits = 0;
+
     move_t rootMoves[Bitboard::MAX_MOVE_NUM];
     int nRootMoves = this->board.genLegalMoves(rootMoves, this->board.getTurn()); // TODO Refactor move gen
     pthread_mutex_lock(&init_lock);
-    int seed = std::random_device()();
+    unsigned int seed = SearchContext::deterministic ? (unsigned int) this->threadIndex : std::random_device()();
     std::mt19937 rng(seed);
     ++SearchContext::nActiveThreads;
     pthread_mutex_unlock(&init_lock);
@@ -473,7 +473,7 @@ void SearchContext::search_t() {
     move_t pv[MAX_DEPTH];
 
     const bool isMainThread = this->threadIndex == 0;
-    for (int16_t d = 1; SearchContext::timeRemaining && d < MAX_DEPTH - 1; ++d) {
+    for (int16_t d = 1; SearchContext::timeRemaining && d <= SearchContext::depthLimit; ++d) {
         int32_t evaluation = MIN_SCORE;
         for (int i = 0; i < nRootMoves; ++i) {
             pv[0] = rootMoves[i];
@@ -494,11 +494,18 @@ void SearchContext::search_t() {
             SearchContext::result.score = evaluation;
             SearchContext::timeManager.finishedIteration(evaluation);
         }
-        this->orderMoves(rootMoves, nRootMoves);
+        /** Reorders the root moves for the next iteration, starting with the best move of this one */
+        MovePicker picker(this->board, this->threadPV[0], this->killerMoves[ply], this->historyTable);
+        nRootMoves = 0;
+        for (move_t move = picker.nextMove().move; !(move == move_t::NULL_MOVE); move = picker.nextMove().move) {
+            rootMoves[nRootMoves++] = move;
+        }
     }
 
     // Thread tear-down code
     if (isMainThread) {
+        /** Depth limit reached before the timer expired, stop the helpers as well */
+        SearchContext::timeRemaining = false;
         while (SearchContext::nActiveThreads > 1);
         pthread_mutex_destroy(&init_lock);
         SearchContext::timeManager.resetTimer();
@@ -510,47 +517,34 @@ void SearchContext::search_t() {
 
 SearchContext::SearchContext(const std::string &fen) : board(fen), position(&(this->board)) {
     pthread_mutex_init(&SearchContext::init_lock, nullptr);
-    SearchContext::transpositionTable.initialize(strtol(uciInstance->getOption(option_t::hashSize).c_str(), nullptr, 10));
+    SearchContext::transpositionTable.initialize(strtoul(uciInstance->getOption(option_t::hashSize).c_str(), nullptr, 10),
+                                                 strtoul(uciInstance->getOption(option_t::threadCount).c_str(), nullptr, 10));
 
     std::memset(this->historyTable, 0, sizeof(int) * HTABLE_LEN);
     std::memset(this->threadPV, 0, MAX_DEPTH * sizeof(move_t));
     this->ply = 0;
-    this->stack = nullptr;
     this->threadIndex = 0;
+    this->nodes = 0;
+    this->evalProbes = 0;
+    this->evalCacheHits = 0;
+    this->ttEvalHits = 0;
 }
 
 SearchContext::SearchContext(size_t threadIndex, const SearchContext &src) : position(&(this->board)) {
     this->board = src.board;
-
-    std::unordered_map<uint64_t, RTEntry>::const_iterator it = src.repetitionTable.begin();
-    const std::unordered_map<uint64_t, RTEntry>::const_iterator end = src.repetitionTable.end();
-
-    while (it != end) {
-        this->repetitionTable.insert(std::pair<uint64_t, RTEntry> (it->first, it->second));
-        ++it;
-    }
+    this->history = src.history;
 
     std::memset(this->historyTable, 0, sizeof(int) * HTABLE_LEN);
     std::memset(this->threadPV, 0, MAX_DEPTH * sizeof(move_t));
     this->ply = 0;
-    this->stack = nullptr;
     this->threadIndex = threadIndex;
+    this->nodes = 0;
+    this->evalProbes = 0;
+    this->evalCacheHits = 0;
+    this->ttEvalHits = 0;
 }
 
 void SearchContext::setUCIInstance(const UCI *uciPtr) {
     if (SearchContext::uciInstance) return;
     SearchContext::uciInstance = uciPtr;
-}
-
-SearchContext::~SearchContext() {
-    // Frees the move stack
-    LinkedStack *iterator = this->stack;
-    LinkedStack *previous;
-
-    while (iterator) {
-        previous = iterator;
-        iterator = iterator->next;
-        delete previous;
-    }
-    this->stack = nullptr;
 }
\ No newline at end of file
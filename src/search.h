@@ -1,14 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <pthread.h>
-#include <stack>
-#include <unordered_map>
 #include <vector>
 
 #include "bitboard.h"
 #include "evaluation.h"
-#include "stack.h"
 #include "tables.h"
 #include "timeman.h"
 #include "uci.h"
@@ -20,6 +18,7 @@ struct SearchContext
 {
 
     friend struct UCI;
+    friend struct Bench;
 private:
     static const UCI *uciInstance;
 
@@ -39,10 +38,16 @@ private:
 
     static const info_t &getResult();
 
-    std::unordered_map<uint64_t, RTEntry> repetitionTable;
+    static const size_t MAX_KILLERS = 2;
 
     Evaluation position;
 
+    EvalCache evalCache;
+
+    // Static evaluations requested by this thread's search, and those found in its cache or in the transposition table.
+    // Written by this thread alone and read by the UCI thread while it searches
+    std::atomic<uint64_t> evalProbes, evalCacheHits, ttEvalHits;
+
     std::vector<move_t> killerMoves[MAX_DEPTH];
 
     move_t threadPV[MAX_DEPTH];
@@ -51,33 +56,43 @@ private:
 
     Bitboard board;
 
-    LinkedStack *stack;
+    // Undo records of every move made since the root position, game moves included
+    std::vector<undo_t> history;
 
     int16_t ply;
 
     size_t threadIndex;
 
-    int16_t computeReduction(move_t, int16_t, int);
+    // Number of moves made by this thread since construction
+    uint64_t nodes;
+
+    int16_t computeReduction(scored_move_t, int16_t, int);
 
-    bool verifyRepetition(uint64_t);
+    int16_t computeExtension(scored_move_t, int16_t);
+
+    bool isRepetition();
 
     bool isDrawn();
 
-    bool useFutilityPruning(move_t, int16_t);
+    bool useFutilityPruning(scored_move_t, int16_t);
 
     size_t hTableIndex(const move_t &);
 
     int32_t moveValue(move_t);
 
-    void storeCutoffMove(move_t, int16_t);
-
-    void orderMoves(move_t *, int);
+    void storeCutoffMove(scored_move_t, int16_t);
 
     void pushMove(const move_t &);
 
     void popMove();
 
-    int32_t qsearch(int32_t, int32_t);
+    /**
+     * @return the static evaluation of the position, from the evaluation cache or the transposition table
+     * when the position was evaluated before.
+     */
+    int32_t staticEval();
+
+    int32_t qsearch(int32_t, int32_t, bool = false);
 
     int32_t pvs(int16_t, int32_t, int32_t, move_t *);
 
@@ -85,6 +100,12 @@ public:
 
     static volatile bool timeRemaining;
 
+    // Deepest iteration of iterative deepening to run
+    static int16_t depthLimit;
+
+    // Seeds root move shuffling with the thread index instead of std::random_device
+    static bool deterministic;
+
     static int32_t pieceValue(piece_t);
 
     static void setUCIInstance(const UCI *);
@@ -93,7 +114,5 @@ public:
 
     SearchContext(size_t threadIndex, const SearchContext &src);
 
-    ~SearchContext();
-
     void search_t();
 };
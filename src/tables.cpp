@@ -2,103 +2,295 @@
 // Created by Alan Tao on 6/18/2023.
 //
 
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <vector>
+
 #include "tables.h"
 #include "util.h"
 
-double TTable::loadFactor = 0.33f;
-
 TTEntry::TTEntry() {
     key = 0;
-    initialized = false;
     flag = EXACT;
     score = 0;
     depth = 0;
 
     bestMove = move_t::NULL_MOVE;
+    staticEval = TTEntry::NO_EVAL;
 }
 
-TTEntry::TTEntry(uint64_t hash_code, int32_t score, int16_t depth, BoundType flag, move_t best_move) {
+TTEntry::TTEntry(uint64_t hash_code, int32_t score, int16_t depth, BoundType flag, move_t best_move,
+                 int16_t static_eval) {
     this->key = hash_code;
 
     this->score = score;
     this->depth = depth;
     this->flag = flag;
     this->bestMove = best_move;
-    initialized = true;
+    this->staticEval = static_eval;
 }
 
-uint64_t TTEntry::operator()() const {
-    return (key ^ depth ^ score ^ flag);
+uint64_t TTSlot::pack(const TTEntry &entry, uint8_t generation) {
+    return ((uint64_t) (uint16_t) entry.score << 48) | ((uint64_t) (uint16_t) entry.staticEval << 32) |
+           ((uint64_t) entry.bestMove.bits() << 16) | ((uint64_t) (uint8_t) entry.depth << 8) |
+           (uint64_t) ((uint8_t) entry.flag | TTSlot::OCCUPIED | generation);
 }
 
-TTEntry &TTEntry::operator=(const TTEntry &other) {
-    depth = other.depth;
-    bestMove = other.bestMove;
-    score = other.score;
-    flag = other.flag;
-    key = other.key ^ depth ^ score ^ flag;
-    initialized = true;
-    return *this;
+TTEntry TTSlot::unpack(uint64_t hash_code, uint64_t data) {
+    return TTEntry(hash_code, (int16_t) (data >> 48), (int8_t) (data >> 8), static_cast<BoundType> (data & 0x3),
+                   move_t::fromBits((uint16_t) (data >> 16)), (int16_t) (data >> 32));
 }
 
 TTable::TTable() {
-    entries = nullptr;
-    size = 0;
-    capacity = 0;
-    hashFull = false;
-}
-
-void TTable::initialize(std::size_t initial_capacity) {
-    if (entries) {
-        clear();
-        hashFull = false;
-    } else {
-        entries = new TTEntry[initial_capacity];
-        size = 0;
-        capacity = initial_capacity;
-        hashFull = false;
+    buckets = nullptr;
+    nBuckets = 0;
+    generation = 0;
+}
+
+void TTable::initialize(std::size_t megabytes, std::size_t nThreads) {
+    /** Largest power of two number of buckets that does not exceed the requested size */
+    std::size_t n = 1;
+    while (2 * n * sizeof(TTBucket) <= megabytes * 1024 * 1024) {
+        n *= 2;
+    }
+
+    if (buckets && n == nBuckets) {
+        return;
     }
+
+    free(buckets);
+    buckets = nullptr;
+    std::size_t bytes = n * sizeof(TTBucket);
+    std::size_t alignment = bytes >= TTable::HUGE_PAGE_SIZE ? TTable::HUGE_PAGE_SIZE : sizeof(TTBucket);
+    if (posix_memalign((void **) &buckets, alignment, bytes)) {
+        std::cout << "juliette:: Failed to allocate transposition table\n";
+        exit(-1);
+    }
+#ifdef MADV_HUGEPAGE
+    /** Back the table with transparent huge pages where available, to cut TLB misses on probes */
+    madvise(buckets, bytes, MADV_HUGEPAGE);
+#endif
+    nBuckets = n;
+    clear(nThreads);
 }
 
 TTable::~TTable() {
-    delete[] entries;
+    free(buckets);
+}
+
+void TTable::newSearch() {
+    generation += TTSlot::GENERATION_DELTA;
+}
+
+TTBucket &TTable::bucketOf(std::uint64_t hash_code) const {
+    return buckets[hash_code & (nBuckets - 1)];
 }
 
 void TTable::insert(const TTEntry &entry) {
-    if (!hashFull) {
-        hashFull = ((double) size / capacity) > loadFactor;
+    TTBucket &bucket = bucketOf(entry.key);
+
+    /**
+     * Overwrite the position if it is already stored, else fill an empty slot, else evict the entry with the
+     * lowest depth, where each generation of age counts as GENERATION_DELTA plies less depth.
+     */
+    TTSlot *replace = &bucket.slots[0];
+    int replaceValue = INT32_MAX;
+    for (int i = 0; i < TTBucket::N_SLOTS; ++i) {
+        TTSlot &slot = bucket.slots[i];
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if (!(data & TTSlot::OCCUPIED) || (key ^ data) == entry.key) {
+            replace = &slot;
+            break;
+        }
+        uint8_t age = (uint8_t) (generation - (data & TTSlot::GENERATION_MASK));
+        int value = (int8_t) (data >> 8) - age;
+        if (value < replaceValue) {
+            replace = &slot;
+            replaceValue = value;
+        }
     }
 
-    for (std::size_t i = 0; i < capacity; ++i) {
-        std::size_t index = (entry.key + i) % capacity;
-        TTEntry &e = entries[index];
+    uint64_t data = TTSlot::pack(entry, generation);
+    replace->key.store(entry.key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
 
-        if (e.initialized && entry.key != e()) {
-            continue;
+bool TTable::find(std::uint64_t hash_code, TTEntry &entry) const {
+    const TTBucket &bucket = bucketOf(hash_code);
+    for (int i = 0; i < TTBucket::N_SLOTS; ++i) {
+        const TTSlot &slot = bucket.slots[i];
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t key = slot.key.load(std::memory_order_relaxed);
+        if ((data & TTSlot::OCCUPIED) && (key ^ data) == hash_code) {
+            entry = TTSlot::unpack(hash_code, data);
+            return true;
         }
-        size += (!e.initialized);
-        e = entry;
-        return;
     }
+    return false;
+}
+
+struct TTClearArgs {
+    TTBucket *begin;
+    std::size_t nBuckets;
+};
+
+static void *ttClearThread(void *arg) {
+    TTClearArgs *args = reinterpret_cast<TTClearArgs *> (arg);
+    std::memset((void *) args->begin, 0, args->nBuckets * sizeof(TTBucket));
+    return nullptr;
 }
 
-TTEntry *TTable::find(std::uint64_t hash_code) {
-    for (std::size_t i = 0, seen = 0; i < capacity && seen < size; ++i) {
-        std::size_t index = (hash_code + i) % capacity;
-        TTEntry &e = entries[index];
-        if (!e.initialized) {
-            return nullptr;
-        } else if (hash_code == e()) {
-            return &entries[index];
+void TTable::clear(std::size_t nThreads) {
+    if (!buckets) return;
+
+    /** Not worth spawning threads for tables smaller than a huge page */
+    nThreads = std::max((std::size_t) 1, std::min(nThreads, nBuckets * sizeof(TTBucket) / TTable::HUGE_PAGE_SIZE));
+
+    std::vector<pthread_t> threads(nThreads);
+    std::vector<TTClearArgs> args(nThreads);
+    const std::size_t chunk = nBuckets / nThreads;
+    for (std::size_t i = 0; i < nThreads; ++i) {
+        args[i].begin = buckets + i * chunk;
+        args[i].nBuckets = (i == nThreads - 1) ? nBuckets - i * chunk : chunk;
+        if (i == 0) continue;
+        if (pthread_create(&(threads[i]), nullptr, ttClearThread, &(args[i]))) {
+            std::cout << "juliette:: Failed to spawn thread!\n";
+            exit(-1);
         }
-        ++seen;
     }
+    /** The calling thread zeroes the first chunk */
+    ttClearThread(&(args[0]));
+    for (std::size_t i = 1; i < nThreads; ++i) {
+        pthread_join(threads[i], nullptr);
+    }
+}
+
+/**
+ * Zeroed entries hold the pawnless position, whose pawn hash code is 0 and whose pawn terms and
+ * bitboards are all 0, so they need no separate empty marker.
+ */
+PawnTable::PawnTable() : entries(PawnTable::N_ENTRIES) {}
+
+PawnEntry &PawnTable::probe(uint64_t pawn_hash_code) {
+    return entries[pawn_hash_code & (PawnTable::N_ENTRIES - 1)];
+}
+
+/**
+ * Both kings are counted in every material key, so zeroed entries match no position. The key packs few bits
+ * into its low end, so it is spread over the index by a multiplication, whose upper 12 bits pick one
+ * of the N_ENTRIES.
+ */
+MaterialTable::MaterialTable() : entries(MaterialTable::N_ENTRIES) {}
+
+MaterialEntry &MaterialTable::probe(uint64_t material_key) {
+    return entries[(material_key * 0x9e3779b97f4a7c15ULL) >> 52];
+}
+
+EvalCache::EvalCache() : entries(EvalCache::N_ENTRIES) {}
+
+bool EvalCache::find(uint64_t hash_code, int32_t &eval) const {
+    const EvalEntry &entry = entries[hash_code & (EvalCache::N_ENTRIES - 1)];
+    if (entry.key != (uint32_t) (hash_code >> 32)) {
+        return false;
+    }
+    eval = entry.eval;
+    return true;
+}
+
+void EvalCache::insert(uint64_t hash_code, int32_t eval) {
+    EvalEntry &entry = entries[hash_code & (EvalCache::N_ENTRIES - 1)];
+    entry.key = (uint32_t) (hash_code >> 32);
+    entry.eval = eval;
+}
+
+struct TTStressArgs {
+    TTable *table;
+    uint64_t seed;
+    std::atomic<uint64_t> *nHits;
+    std::atomic<uint64_t> *nCorrupted;
+};
+
+/**
+ * Number of different entries the threads store for each test position. They share the score and the best
+ * move, as when a position is stored again at another depth, so that a slot torn between two of them is
+ * only told apart by the depth, the bound and the static eval.
+ */
+static const int N_VARIANTS = 4;
+
+/**
+ * @param key hash code of a test position.
+ * @param variant which of the N_VARIANTS entries of the position.
+ * @return the entry threads store for the position.
+ */
+static TTEntry expectedEntry(uint64_t key, int variant) {
+    move_t mv = {(unsigned int) (key & 0x3f), (unsigned int) ((key >> 6) & 0x3f), (unsigned int) ((key >> 12) & 0xf)};
+    return TTEntry(key, (int16_t) (key >> 48), (int16_t) (((key >> 20) & 0x3f) + variant),
+                   static_cast<BoundType> (((key >> 26) + variant) % 3), mv, (int16_t) ((key >> 32) + 1021 * variant));
+}
+
+static bool sameEntry(const TTEntry &a, const TTEntry &b) {
+    return a.key == b.key && a.score == b.score && a.depth == b.depth && a.flag == b.flag && a.bestMove == b.bestMove &&
+           a.staticEval == b.staticEval;
+}
+
+static void *ttStressThread(void *arg) {
+    const int N_KEYS = 8192;
+    const int N_ITERATIONS = 1000000;
+
+    TTStressArgs *args = reinterpret_cast<TTStressArgs *> (arg);
+    uint64_t state = args->seed;
+    uint64_t nHits = 0, nCorrupted = 0;
+    for (int i = 0; i < N_ITERATIONS; ++i) {
+        /**
+         * Keys are drawn from a small fixed set and mapped to the first 256 buckets only, so that threads
+         * keep colliding on the same buckets and most inserts evict entries written by other threads.
+         */
+        uint64_t keyState = BitUtils::splitmix64(state) % N_KEYS;
+        uint64_t key = (BitUtils::splitmix64(keyState) & ~0xffffULL) | (keyState & 0xff);
+        args->table->insert(expectedEntry(key, (int) (BitUtils::splitmix64(state) % N_VARIANTS)));
+
+        keyState = BitUtils::splitmix64(state) % N_KEYS;
+        key = (BitUtils::splitmix64(keyState) & ~0xffffULL) | (keyState & 0xff);
+        TTEntry entry;
+        if (args->table->find(key, entry)) {
+            ++nHits;
+            bool valid = false;
+            for (int v = 0; v < N_VARIANTS; ++v) {
+                valid = valid || sameEntry(entry, expectedEntry(key, v));
+            }
+            nCorrupted += !valid;
+        }
+    }
+    *(args->nHits) += nHits;
+    *(args->nCorrupted) += nCorrupted;
     return nullptr;
 }
 
-void TTable::clear() {
-    size = 0;
-    for (std::size_t i = 0; i < capacity; ++i) {
-        entries[i].initialized = false;
+bool test_transposition_table() {
+    const int N_THREADS = 16;
+
+    TTable table;
+    table.initialize(1, 1);
+
+    std::atomic<uint64_t> nHits(0), nCorrupted(0);
+    pthread_t threads[N_THREADS];
+    TTStressArgs args[N_THREADS];
+    for (int i = 0; i < N_THREADS; ++i) {
+        args[i] = {&table, (uint64_t) i + 1, &nHits, &nCorrupted};
+        if (pthread_create(&(threads[i]), nullptr, ttStressThread, &(args[i]))) {
+            std::cout << "juliette:: Failed to spawn thread!\n";
+            exit(-1);
+        }
     }
-}
\ No newline at end of file
+    for (int i = 0; i < N_THREADS; ++i) {
+        pthread_join(threads[i], nullptr);
+    }
+
+    std::cout << "juliette:: transposition table stress test: " << nHits << " hits, " << nCorrupted
+              << " corrupted entries" << std::endl;
+    return nHits > 0 && nCorrupted == 0;
+}
@@ -3,16 +3,22 @@
 //
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "util.h"
 
+struct Bitboard;
+
 enum BoundType {
     EXACT, LOWER, UPPER
 };
 
 struct TTEntry {
+    static const int16_t NO_EVAL = INT16_MIN; // Static evaluation of the position not known
+
     uint64_t key;
 
     BoundType flag;
@@ -21,54 +27,219 @@ struct TTEntry {
     int16_t depth;
     move_t bestMove;
 
-    bool initialized;
+    int16_t staticEval;
 
     TTEntry();
 
-    TTEntry(uint64_t hash_code, int32_t score, int16_t depth, BoundType flag, move_t best_move);
+    TTEntry(uint64_t hash_code, int32_t score, int16_t depth, BoundType flag, move_t best_move,
+            int16_t static_eval = TTEntry::NO_EVAL);
+};
+
+/**
+ * Packed 16 byte form of a TTEntry, as stored in the table. The table is shared by all search
+ * threads without locks, so the hash code is stored XORed with the data word. A slot torn by concurrent
+ * writers then fails verification and reads as a miss instead of returning mismatched fields.
+ *
+ * Data word layout:
+ * MSB                                                  LSB
+ * ________________  ________________  ________________  ________  _____ _ __
+ *       Score          Static eval        Best move       Depth    Gen  O Bound
+ *
+ * Gen is the generation of the search that wrote the slot, O is the OCCUPIED bit. Scores of the search
+ * fit in 16 bits.
+ */
+struct TTSlot {
+    std::atomic<uint64_t> key; // hash code ^ data
+    std::atomic<uint64_t> data;
+
+    static const uint8_t OCCUPIED = 0x4; // Set in the flag byte once written, BoundType in the lower two bits
+
+    static const uint8_t GENERATION_DELTA = 0x8; // Generation occupies the upper five bits of the flag byte
+    static const uint8_t GENERATION_MASK = 0xf8;
+
+    static uint64_t pack(const TTEntry &, uint8_t generation);
+
+    static TTEntry unpack(uint64_t hash_code, uint64_t data);
+};
 
-    uint64_t operator()() const;
+/**
+ * One cache line worth of slots. A position may only be stored in the bucket its hash code maps to,
+ * so every probe touches exactly one cache line.
+ */
+struct alignas(64) TTBucket {
+    static const int N_SLOTS = 4;
 
-    TTEntry &operator=(const TTEntry &other);
+    TTSlot slots[N_SLOTS];
 };
 
 struct TTable {
 
-    bool hashFull;
-
     TTable();
 
     ~TTable();
 
-    void initialize(std::size_t initial_capacity);
+    /**
+     * Allocates and zeroes the table, rounding the number of buckets down to a power of two. Does
+     * nothing if the table is already allocated with the same size, so entries survive between moves.
+     * @param megabytes the size of the table in megabytes.
+     * @param nThreads the number of threads to zero the table with.
+     */
+    void initialize(std::size_t megabytes, std::size_t nThreads);
+
+    /**
+     * Advances the generation stamped into inserted entries. Must be called before the search threads
+     * are spawned. Entries of earlier searches are then evicted ahead of deeper entries of this one.
+     */
+    void newSearch();
 
     void insert(const TTEntry &entry);
 
-    TTEntry *find(std::uint64_t hash_code);
+    /**
+     * @param hash_code the hash code of the position.
+     * @param entry set to the stored entry of the position, if any.
+     * @return whether the position is stored in the table.
+     */
+    bool find(std::uint64_t hash_code, TTEntry &entry) const;
 
-    void clear();
+    /**
+     * Zeroes the table, split into one contiguous chunk per thread. On a freshly allocated table this
+     * is also the first touch of its pages, which places them near the threads that will search.
+     * @param nThreads the number of threads to zero the table with.
+     */
+    void clear(std::size_t nThreads);
 
 private:
 
-    static double loadFactor;
+    static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    std::size_t nBuckets;
+    TTBucket *buckets;
+    uint8_t generation;
+
+    TTBucket &bucketOf(std::uint64_t hash_code) const;
+};
+
+/**
+ * Pawn structure terms of the evaluation, and the pawn bitboards derived for them that the rest of the
+ * evaluation reuses. Arrays are indexed by color.
+ */
+struct PawnEntry {
+    uint64_t key; // pawn hash code
+
+    int32_t midgameScore;
+    int32_t endgameScore;
+
+    uint64_t rearspans[2];
+    uint64_t attacks[2];
+};
+
+/**
+ * Cache of pawn structure evaluations indexed by the pawn hash code. Pawns move in few of the positions
+ * a search visits, so most evaluations find their pawn terms here. Each search thread owns its table, so
+ * entries are read and written without any synchronization.
+ */
+struct PawnTable {
+
+    static const std::size_t N_ENTRIES = 16384;
+
+    PawnTable();
+
+    /**
+     * @param pawn_hash_code the pawn hash code of the position.
+     * @return the entry the position maps to. It holds the position only if its key matches, else the
+     * caller overwrites it.
+     */
+    PawnEntry &probe(uint64_t pawn_hash_code);
+
+private:
 
-    std::size_t size, capacity;
-    TTEntry *entries;
+    std::vector<PawnEntry> entries;
 };
 
-struct RTEntry {
+/**
+ * Evaluator of a known endgame.
+ * @param strong_side the color that has the winning material.
+ * @return the score of the position from the point of view of the strong side.
+ */
+typedef int32_t (*endgame_fn)(const Bitboard &, bool strong_side);
 
-    uint8_t num_seen;
+/**
+ * Terms of the evaluation that depend on the number of pieces of each piece_t alone. Arrays are indexed by
+ * color.
+ */
+struct MaterialEntry {
+    static const uint8_t SCALE_NORMAL = 64;
 
-    explicit RTEntry(uint8_t n) : num_seen(n) {};
+    uint64_t key; // material key
+
+    int32_t midgameImbalance;
+    int32_t endgameImbalance;
+
+    // Out of SCALE_NORMAL, the factor of the score when it favors the color, below normal if it can rarely win
+    uint8_t scale[2];
+
+    // Specialized evaluator that replaces the whole evaluation, or nullptr
+    endgame_fn endgame;
+    bool strongSide;
+};
+
+/**
+ * Cache of the material terms of the evaluation indexed by the material key. A search meets few material
+ * configurations, so nearly every probe hits. Each search thread owns its table, so entries are read and
+ * written without any synchronization.
+ */
+struct MaterialTable {
+
+    static const std::size_t N_ENTRIES = 4096;
+
+    MaterialTable();
+
+    /**
+     * @param material_key the material key of the position.
+     * @return the entry the position maps to. It holds the position only if its key matches, else the
+     * caller overwrites it.
+     */
+    MaterialEntry &probe(uint64_t material_key);
+
+private:
+
+    std::vector<MaterialEntry> entries;
+};
+
+/**
+ * Direct-mapped cache of static evaluations indexed by the hash code, so that positions the search
+ * reaches again are not evaluated again. Each search thread owns its cache, so entries are read and
+ * written without any synchronization.
+ */
+struct EvalCache {
+
+    static const std::size_t N_ENTRIES = 65536;
+
+    EvalCache();
+
+    /**
+     * @param hash_code the hash code of the position.
+     * @param eval set to the stored static evaluation of the position, if any.
+     * @return whether the position is stored in the cache.
+     */
+    bool find(uint64_t hash_code, int32_t &eval) const;
+
+    void insert(uint64_t hash_code, int32_t eval);
+
+private:
 
-    RTEntry() {
-        num_seen = 0;
-    }
+    struct EvalEntry {
+        uint32_t key; // upper half of the hash code
+        int32_t eval;
+    };
 
-    RTEntry(const RTEntry &other) {
-        num_seen = other.num_seen;
-    }
+    std::vector<EvalEntry> entries;
 };
 
-void test_transposition_table();
\ No newline at end of file
+/**
+ * Stress test of the shared transposition table. Many threads concurrently insert and probe a small
+ * set of positions whose entry fields are derived from their hash codes, and every entry read back is
+ * checked against its hash code.
+ * @return whether every entry read back was valid.
+ */
+bool test_transposition_table();
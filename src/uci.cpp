@@ -4,7 +4,6 @@
 #include <unordered_map>
 
 #include "bitboard.h"
-#include "stack.h"
 #include "timeman.h"
 #include "uci.h"
 #include "util.h"
@@ -24,13 +23,17 @@ const std::string UCI::replies[8] = {"id", "uciok", "readyok", "bestmove", "copy
 
 void info_t::formatData(char buf[], size_t n, bool verbose) const {
     if (verbose) {
-        std::string format("elapsed time: (%ld)ms\n%s:  %c%d%c%d\nevaluation: %d");
+        std::string format("elapsed time: (%ld)ms\n%s:  %c%d%c%d\nevaluation: %d\n"
+                           "eval cache: %llu/%llu hits (%.1f%%), %llu more from the transposition table");
         // TODO: If mate score, format to M(n)
         snprintf(buf, BUFLEN, format.c_str(),
                  static_cast<long> (this->elapsedTime.count()), UCI::replies[bestmove].c_str(),
                  char(Bitboard::fileOf(this->bestMove.from) + 'a'),
                  int(Bitboard::rankOf(this->bestMove.from) + 1), char(Bitboard::fileOf(this->bestMove.to) + 'a'),
-                 int(Bitboard::rankOf(this->bestMove.to) + 1), score);
+                 int(Bitboard::rankOf(this->bestMove.to) + 1), score,
+                 (unsigned long long) this->evalCacheHits, (unsigned long long) this->evalProbes,
+                 100.0 * (double) this->evalCacheHits / (double) std::max(this->evalProbes, (uint64_t) 1),
+                 (unsigned long long) this->ttEvalHits);
     } else {
         snprintf(buf, BUFLEN, "%s: %c%d%c%d\n", UCI::replies[bestmove].c_str(),
                  char(Bitboard::fileOf(this->bestMove.from) + 'a'), int(Bitboard::rankOf(this->bestMove.from) + 1),
@@ -59,7 +62,7 @@ void UCI::initializeUCI() {
     options.insert(std::pair<option_t, std::string>(option_t::debug, "off"));
     options.insert(std::pair<option_t, std::string>(option_t::threadCount, "14"));
     options.insert(std::pair<option_t, std::string>(option_t::contempt, "0"));
-    options.insert(std::pair<option_t, std::string>(option_t::hashSize, "25165824"));
+    options.insert(std::pair<option_t, std::string>(option_t::hashSize, "256"));
     TimeManager::setUCIInstance(this);
 }
 
@@ -80,7 +83,8 @@ void UCI::parseUCIString(const char *uci) {
         this->reply();
     } else if (cmd == "ucinewgame") {
         this->boardInitialized = false;
-        Bitboard::initializeZobrist();
+        /** Start the new game from an empty table */
+        SearchContext::transpositionTable.clear((size_t) std::stoi(this->options[option_t::threadCount]));
     } else if (cmd == "isready") {
         snprintf(this->sendbuf, BUFLEN, "readyok");
         this->reply();
@@ -99,7 +103,7 @@ void UCI::parseUCIString(const char *uci) {
         this->setOption(tokens);
     } else if (cmd == "stop") {
         SearchContext::timeRemaining = false;
-        SearchContext::result.formatData(this->sendbuf, BUFLEN, this->options[option_t::debug] == "on");
+        this->formatData();
         this->reply();
         this->joinThreads();
     } else if (cmd == "quit") {
@@ -205,6 +209,7 @@ void UCI::go(const std::vector<std::string> &args) {
         }
     }
     SearchContext::timeManager.initializeTimer(mainThread->board.getTurn(), wTime, wInc, bTime, bInc, movesToGo);
+    SearchContext::transpositionTable.newSearch();
     SearchContext::timeManager.startTimer();
     int status = pthread_create(&(this->threads[0]), nullptr, threadFunction, (void *) this->mainThread);
     if (status) {
@@ -223,6 +228,15 @@ void UCI::go(const std::vector<std::string> &args) {
 }
 
 void UCI::formatData() {
+    /** Tally the evaluation cache counters of every search thread */
+    info_t &result = SearchContext::result;
+    result.evalProbes = result.evalCacheHits = result.ttEvalHits = 0;
+    for (size_t i = 0; this->mainThread && i < std::max(this->nThreads, (size_t) 1); ++i) {
+        const SearchContext *context = i == 0 ? this->mainThread : this->helperThreads[i - 1];
+        result.evalProbes += context->evalProbes.load(std::memory_order_relaxed);
+        result.evalCacheHits += context->evalCacheHits.load(std::memory_order_relaxed);
+        result.ttEvalHits += context->ttEvalHits.load(std::memory_order_relaxed);
+    }
     SearchContext::getResult().formatData(this->sendbuf, BUFLEN, this->options[option_t::debug] == "on");
 }
 
@@ -231,6 +245,12 @@ void UCI::reply() {
 }
 
 void UCI::setOption(const std::vector<std::string> &args) {
+    /** Button option, takes no value */
+    if (args.size() == 3 && args[0] == "name" && args[1] == "Clear" && args[2] == "Hash") {
+        SearchContext::transpositionTable.clear((size_t) std::stoi(this->options[option_t::threadCount]));
+        return;
+    }
+
     if (args.size() != 4 || args[0] != "name" || args[2] != "value") {
         snprintf(this->sendbuf, BUFLEN, "juliette:: syntax: setoption name [name] value [value]");
         this->reply();
@@ -270,11 +290,13 @@ void UCI::setOption(const std::vector<std::string> &args) {
             snprintf(this->sendbuf, BUFLEN, "juliette:: thread count must be a number greater than 0");
         }
         this->reply();
-    } else if (args[1] == "hashSize") {
-        if (StringUtils::isNumber(args[3])) {
+    } else if (args[1] == "Hash" || args[1] == "hashSize") {
+        int hashSize;
+
+        if (StringUtils::isNumber(&hashSize, args[3]) && hashSize > 0) {
             options[option_t::hashSize] = args[3];
         } else {
-            snprintf(this->sendbuf, BUFLEN, "juliette:: hash size must be a number");
+            snprintf(this->sendbuf, BUFLEN, "juliette:: hash size must be a number of megabytes greater than 0");
             this->reply();
         }
     } else {
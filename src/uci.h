@@ -33,6 +33,9 @@ struct info_t
     move_t bestMove;
     std::chrono::milliseconds elapsedTime;
 
+    // Static evaluations requested by all threads, and those found in the evaluation caches or the transposition table
+    uint64_t evalProbes, evalCacheHits, ttEvalHits;
+
     void formatData(char *, size_t, bool) const;
 };
 
@@ -13,38 +13,28 @@ const move_t move_t::STALEMATE = {H8, H8, PASS};
 // Maximum amount of material that can be lost in any exchange
 const int32_t MAX_MATERIAL_LOSS = Weights::MATERIAL[piece_t::BLACK_QUEEN];
 
-uint64_t BitUtils::getRandomBitstring()  {
-    uint64_t out = 0;
-    uint64_t mask = 1ULL;
-    int i = 0;
-    while (i++ < 63) {
-        if (rand() % 2) {
-            out |= mask;
-        }
-        mask <<= 1;
-    }
-    return out;
-}
-
-int32_t move_t::normalizeScore() const {
+int32_t scored_move_t::normalizeScore() const {
     return (SCORE_MASK & score) - MAX_MATERIAL_LOSS;
 }
 
-void move_t::setScore(move_t::type_t t, int32_t s) {
+void scored_move_t::setScore(scored_move_t::type_t t, int32_t s) {
     score |= (1 << (24 + t));
     s += MAX_MATERIAL_LOSS;
-    score |= (s & move_t::SCORE_MASK);
+    score |= (s & scored_move_t::SCORE_MASK);
 }
 
-bool move_t::isType(move_t::type_t t) const {
-    return (score & (1 << (24 + t))) != 0;
+/**
+ * Tags the move with an additional type, leaving its score untouched.
+ */
+void scored_move_t::setType(scored_move_t::type_t t) {
+    score |= (1 << (24 + t));
 }
 
-bool move_t::operator==(const move_t &other) const {
-    return to == other.to && from == other.from && flag == other.flag;
+bool scored_move_t::isType(scored_move_t::type_t t) const {
+    return (score & (1 << (24 + t))) != 0;
 }
 
-bool move_t::operator<(const move_t &other) const {
+bool scored_move_t::operator<(const scored_move_t &other) const {
     return score > other.score;
 }
 
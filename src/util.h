@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <vector>
 
@@ -50,7 +52,7 @@ enum MoveFlags
  * Indexed enumeration of piece types.
  */
 
-enum piece_t 
+enum piece_t : uint8_t
 {
     BLACK_PAWN, BLACK_KNIGHT, BLACK_BISHOP, BLACK_ROOK, BLACK_QUEEN, BLACK_KING,
     WHITE_PAWN, WHITE_KNIGHT, WHITE_BISHOP, WHITE_ROOK, WHITE_QUEEN, WHITE_KING,
@@ -58,7 +60,12 @@ enum piece_t
 };
 
 /**
- * Representation of a move.
+ * Representation of a move, packed into 16 bits. This is the form moves are stored in, in the
+ * transposition table, principal variations, killer lists and undo records.
+ *
+ * MSB                LSB
+ * ____  ______  ______
+ * Flag    To     From
  */
 struct move_t 
 {
@@ -67,15 +74,52 @@ struct move_t
     static const move_t CHECKMATE;
     static const move_t STALEMATE;
 
+    uint16_t from: 6;
+    uint16_t to: 6;
+    uint16_t flag: 4;
+
+    move_t() = default;
+
+    constexpr move_t(unsigned int from, unsigned int to, unsigned int flag) : from(from), to(to), flag(flag) {}
+
+    /**
+     * @return the 16 bit encoding of the move.
+     */
+    uint16_t bits() const {
+        uint16_t encoded;
+        std::memcpy(&encoded, this, sizeof(encoded));
+        return encoded;
+    }
+
+    static move_t fromBits(uint16_t bits) {
+        move_t move;
+        std::memcpy(&move, &bits, sizeof(bits));
+        return move;
+    }
+
+    bool operator==(const move_t &other) const {
+        return this->bits() == other.bits();
+    }
+
+    std::string to_string() const;
+};
+
+static_assert(sizeof(move_t) == 2, "move_t must pack into 16 bits");
+
+/**
+ * A move together with its ordering score. Only used while the moves of a node are being ordered,
+ * and to tell the search what kind of move it was handed.
+ */
+struct scored_move_t 
+{
+
     static const int32_t SCORE_MASK = 0xFFFFFF;
 
     enum type_t {
         LOSING_EXCHANGE, QUIET, KILLER_MOVE, WINNING_EXCHANGE, CHECK_MOVE, HASH_MOVE
     };
 
-    unsigned int from: 6;
-    unsigned int to: 6;
-    unsigned int flag: 4;
+    move_t move;
 
     /**
      * Most significant 8-bits of the following integer are used to disambiguate the move "type".
@@ -92,18 +136,27 @@ struct move_t
 
     void setScore(type_t, int32_t);
 
-    bool isType(type_t) const;
-
-    bool operator==(const move_t &) const;
+    void setType(type_t);
 
-    bool operator<(const move_t &) const;
+    bool isType(type_t) const;
 
-    std::string to_string() const;
+    bool operator<(const scored_move_t &) const;
 };
 
 namespace BitUtils 
 {
-    uint64_t getRandomBitstring();
+    /**
+     * splitmix64 generator, usable at compile time. Every 64 bit output is equally likely, and a
+     * fixed seed always gives the same sequence.
+     * @param state the state of the generator, advanced by each call.
+     * @return the next pseudo random number.
+     */
+    constexpr uint64_t splitmix64(uint64_t &state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
 
     int getLSB(uint64_t);
 
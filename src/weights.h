@@ -175,6 +175,8 @@ namespace Weights {
         };
         const int32_t KING_DIST = 3;
         const int32_t KING_EDGE = 6;
+
+        const int32_t BISHOP_PAIR = 50;
     }
 
     const int32_t board_ctrl_tb[64] = {
@@ -202,4 +204,9 @@ namespace Weights {
             16 * PAWN_PHASE + 4 * KNIGHT_PHASE + 4 * BISHOP_PHASE + 4 * ROOK_PHASE + 2 * QUEEN_PHASE;
 
     const int32_t DELTA_MARGIN = 200;
+
+    /**
+     * Centi-pawn bonus for holding both bishops, the material imbalance term.
+     */
+    const int32_t BISHOP_PAIR = 30;
 }
\ No newline at end of file